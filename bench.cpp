@@ -0,0 +1,307 @@
+#include "engine_exceptions.hpp" // for EngineError
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+#include "job_system.hpp"        // for JobSystem
+#include "material.hpp"          // for Material
+#include "mesh.hpp"              // for Mesh
+#include "renderer.hpp"          // for Renderer
+#include "shader.hpp"            // for Shader
+#include "vertex.hpp"            // for Vertex, InstanceData
+#include <algorithm>             // for sort
+#include <charconv>              // for from_chars
+#include <chrono>                // for steady_clock, duration
+#include <cmath>                 // for ceil, sqrt
+#include <cstddef>               // for size_t
+#include <cstdio>                // for stderr
+#include <exception>             // for exception
+#include <filesystem>            // for path
+#include <map>                   // for map
+#include <memory>                // for unique_ptr, make_unique
+#include <optional>              // for optional
+#include <print>                 // for println
+#include <span>                  // for span
+#include <string_view>           // for string_view
+#include <system_error>          // for errc
+#include <vector>                // for vector
+#include <vulkan/vulkan_core.h>  // for VkExtent2D, VK_SHADER_STAGE_VERTEX_BIT
+
+// Renders a grid of triangles offscreen for a fixed number of frames and
+// prints frame time percentiles, draw/submit counts and memory use as JSON.
+// Needs no window, so it runs on a software ICD such as lavapipe:
+//   bench [--frames N] [--warmup N] [--meshes N] [--width N] [--height N]
+//         [--frames-in-flight N] [--max-queued N] [--instanced 0|1]
+//         [--gpu-culling 0|1] [--recording-threads N] [--job-system 0|1]
+
+namespace {
+
+struct Options {
+  std::size_t frames = 1000;
+  std::size_t warmup = 50;
+  std::size_t meshes = 256;
+  unsigned width = 1280;
+  unsigned height = 720;
+  std::size_t frames_in_flight =
+      engine::core::Renderer::DEFAULT_FRAMES_IN_FLIGHT;
+  std::size_t max_queued = 0; // 0 -- same as frames in flight
+  unsigned instanced = 0;     // 1 -- one instanced draw for the whole grid
+  unsigned gpu_culling = 0;   // 1 -- cull the instanced grid in compute
+  std::size_t recording_threads = 1;
+  unsigned job_system = 0; // 1 -- record on a shared work-stealing pool
+};
+
+template <typename T> bool parse(std::string_view text, T &value) {
+  const auto [end, ec] =
+      std::from_chars(text.data(), text.data() + text.size(), value);
+  return ec == std::errc{} && end == text.data() + text.size();
+}
+
+bool parse_options(std::span<char *> args, Options &options) {
+  for (std::size_t i = 1; i + 1 < args.size(); i += 2) {
+    const std::string_view name = args[i];
+    const std::string_view value = args[i + 1];
+    bool ok = false;
+    if (name == "--frames") {
+      ok = parse(value, options.frames);
+    } else if (name == "--warmup") {
+      ok = parse(value, options.warmup);
+    } else if (name == "--meshes") {
+      ok = parse(value, options.meshes);
+    } else if (name == "--width") {
+      ok = parse(value, options.width);
+    } else if (name == "--height") {
+      ok = parse(value, options.height);
+    } else if (name == "--frames-in-flight") {
+      ok = parse(value, options.frames_in_flight);
+    } else if (name == "--max-queued") {
+      ok = parse(value, options.max_queued);
+    } else if (name == "--instanced") {
+      ok = parse(value, options.instanced) && options.instanced <= 1;
+    } else if (name == "--gpu-culling") {
+      ok = parse(value, options.gpu_culling) && options.gpu_culling <= 1;
+    } else if (name == "--recording-threads") {
+      ok = parse(value, options.recording_threads);
+    } else if (name == "--job-system") {
+      ok = parse(value, options.job_system) && options.job_system <= 1;
+    }
+    if (!ok) {
+      std::println(stderr, "bad argument: {} {}", name, value);
+      return false;
+    }
+  }
+  return args.size() % 2 == 1 && options.frames != 0 && options.meshes != 0 &&
+         options.width != 0 && options.height != 0;
+}
+
+// one material per mesh on purpose: identical materials must end up sharing
+// their pipeline, which the bench measures as well. The instanced variant
+// draws the same grid from a single mesh and material
+class Scene {
+private:
+  struct PushConstant {
+    glm::mat4 MVP{1.0f};
+    float time = 0.0f;
+  };
+
+  std::vector<engine::resources::Vertex> m_vertices = {
+      {{-0.5f, 0.5f, 0.0f}, {}, {}, {1.0f, 0.0f, 1.0f}},
+      {{0.0f, -0.5f, 0.0f}, {}, {}, {0.0f, 1.0f, 1.0f}},
+      {{0.5f, 0.5f, 0.0f}, {}, {}, {0.0f, 0.0f, 1.0f}},
+  };
+  std::vector<unsigned> m_indices = {0, 1, 2};
+
+  std::vector<PushConstant> m_push_constants;
+  std::vector<engine::resources::InstanceData> m_instances;
+  std::vector<std::unique_ptr<engine::resources::Material>> m_materials;
+  std::vector<std::unique_ptr<engine::resources::Mesh>> m_meshes;
+
+  static glm::mat4 grid_transform(std::size_t i, std::size_t count) {
+    const auto side = static_cast<std::size_t>(
+        std::ceil(std::sqrt(static_cast<double>(count))));
+    const float cell = 2.0f / static_cast<float>(side);
+    const float column = static_cast<float>(i % side);
+    const float row = static_cast<float>(i / side);
+    const glm::vec3 center{-1.0f + cell * (column + 0.5f),
+                           -1.0f + cell * (row + 0.5f), 0.0f};
+    return glm::translate(glm::mat4{1.0f}, center) *
+           glm::scale(glm::mat4{1.0f}, glm::vec3(cell * 0.8f));
+  }
+
+  void make_instanced(engine::core::Renderer &renderer, std::size_t count) {
+    using enum engine::core::Shader::Stage;
+    m_push_constants.resize(1); // identity view-projection
+    m_instances.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+      m_instances[i].transform = grid_transform(i, count);
+    }
+
+    m_materials.push_back(std::make_unique<engine::resources::Material>(
+        renderer,
+        std::map<engine::core::Shader::Stage, std::filesystem::path>{
+            {VERTEX, "instanced.vert.glsl.spv"},
+            {FRAGMENT, "triangle.frag.glsl.spv"}},
+        m_push_constants.data(), sizeof(PushConstant),
+        VK_SHADER_STAGE_VERTEX_BIT, true));
+    m_meshes.push_back(std::make_unique<engine::resources::Mesh>(
+        renderer, m_vertices, m_indices, m_materials.back().get()));
+    renderer.submit_instanced(m_meshes.back().get(), m_instances);
+  }
+
+  void make_separate(engine::core::Renderer &renderer, std::size_t count) {
+    using enum engine::core::Shader::Stage;
+    m_push_constants.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+      m_push_constants[i].MVP = grid_transform(i, count);
+
+      m_materials.push_back(std::make_unique<engine::resources::Material>(
+          renderer,
+          std::map<engine::core::Shader::Stage, std::filesystem::path>{
+              {VERTEX, "triangle.vert.glsl.spv"},
+              {FRAGMENT, "triangle.frag.glsl.spv"}},
+          &m_push_constants[i], sizeof(PushConstant),
+          VK_SHADER_STAGE_VERTEX_BIT));
+      m_meshes.push_back(std::make_unique<engine::resources::Mesh>(
+          renderer, m_vertices, m_indices, m_materials.back().get()));
+      renderer.submit_mesh(m_meshes.back().get());
+    }
+  }
+
+public:
+  Scene(engine::core::Renderer &renderer, std::size_t mesh_count,
+        bool instanced) {
+    if (instanced) {
+      make_instanced(renderer, mesh_count);
+    } else {
+      make_separate(renderer, mesh_count);
+    }
+
+    // measure rendering, not pipeline compilation
+    for (const auto &material : m_materials) {
+      material->wait();
+    }
+  }
+
+  void update(float time) {
+    for (PushConstant &constant : m_push_constants) {
+      constant.time = time;
+    }
+  }
+};
+
+double percentile(const std::vector<double> &sorted, double p) {
+  const auto index = static_cast<std::size_t>(
+      p * static_cast<double>(sorted.size() - 1) + 0.5);
+  return sorted[index];
+}
+
+} // namespace
+
+int main(int argc, char **argv) try {
+  Options options;
+  if (!parse_options(std::span(argv, static_cast<std::size_t>(argc)),
+                     options)) {
+    return 2;
+  }
+
+  // declared first, it must outlive the renderer
+  std::optional<engine::core::JobSystem> jobs;
+  engine::core::Renderer renderer(
+      VkExtent2D{.width = options.width, .height = options.height});
+  renderer.set_frames_in_flight(options.frames_in_flight);
+  if (options.max_queued != 0) {
+    renderer.set_max_queued_frames(options.max_queued);
+  }
+  if (options.gpu_culling != 0 && !renderer.set_gpu_culling(true)) {
+    std::println(stderr, "GPU culling is not supported by the device");
+    return 1;
+  }
+  if (options.job_system != 0) {
+    renderer.set_job_system(&jobs.emplace());
+  }
+  renderer.set_recording_threads(options.recording_threads);
+  Scene scene(renderer, options.meshes, options.instanced != 0);
+
+  using clock = std::chrono::steady_clock;
+  const auto render = [&renderer, &scene](std::size_t frame) {
+    scene.update(static_cast<float>(frame) / 60.0f);
+    renderer.render_frame();
+  };
+
+  for (std::size_t i = 0; i < options.warmup; ++i) {
+    render(i);
+  }
+  renderer.wait_idle();
+  const engine::core::Renderer::Stats before = renderer.stats();
+
+  std::vector<double> frame_ms;
+  frame_ms.reserve(options.frames);
+  const auto start = clock::now();
+  for (std::size_t i = 0; i < options.frames; ++i) {
+    const auto frame_start = clock::now();
+    render(options.warmup + i);
+    frame_ms.push_back(
+        std::chrono::duration<double, std::milli>(clock::now() - frame_start)
+            .count());
+  }
+  renderer.wait_idle();
+  const double total_ms =
+      std::chrono::duration<double, std::milli>(clock::now() - start).count();
+
+  const engine::core::Renderer::Stats after = renderer.stats();
+  const auto memory = renderer.allocator().stats();
+  std::sort(frame_ms.begin(), frame_ms.end());
+
+  std::println("{{");
+  std::println("  \"frames\": {},", options.frames);
+  std::println("  \"meshes\": {},", options.meshes);
+  std::println("  \"instanced\": {},", options.instanced != 0);
+  std::println("  \"gpu_culling\": {},", renderer.gpu_culling());
+  std::println("  \"extent\": [{}, {}],", options.width, options.height);
+  std::println("  \"frames_in_flight\": {},", renderer.frames_in_flight());
+  std::println("  \"max_queued_frames\": {},", renderer.max_queued_frames());
+  std::println("  \"recording_threads\": {},", renderer.recording_threads());
+  std::println("  \"job_system\": {},", options.job_system != 0);
+  std::println("  \"total_ms\": {:.3f},", total_ms);
+  std::println("  \"fps\": {:.2f},",
+               static_cast<double>(options.frames) * 1000.0 / total_ms);
+  std::println("  \"frame_ms\": {{\"min\": {:.4f}, \"p50\": {:.4f}, "
+               "\"p90\": {:.4f}, \"p99\": {:.4f}, \"max\": {:.4f}}},",
+               frame_ms.front(), percentile(frame_ms, 0.5),
+               percentile(frame_ms, 0.9), percentile(frame_ms, 0.99),
+               frame_ms.back());
+  std::println("  \"draw_calls_per_frame\": {:.2f},",
+               static_cast<double>(after.draw_calls - before.draw_calls) /
+                   static_cast<double>(options.frames));
+  std::println("  \"pipeline_binds_per_frame\": {:.2f},",
+               static_cast<double>(after.pipeline_binds -
+                                   before.pipeline_binds) /
+                   static_cast<double>(options.frames));
+  std::println("  \"vertex_buffer_binds_per_frame\": {:.2f},",
+               static_cast<double>(after.vertex_buffer_binds -
+                                   before.vertex_buffer_binds) /
+                   static_cast<double>(options.frames));
+  std::println("  \"graphics_submits\": {},",
+               after.graphics_submits - before.graphics_submits);
+  std::println("  \"transfer_submits\": {},",
+               after.transfer_submits - before.transfer_submits);
+  std::println("  \"live_pipelines\": {},",
+               renderer.pipelines().stats().live_pipelines);
+  std::println("  \"memory\": {{\"blocks\": {}, \"allocations\": {}, "
+               "\"reserved_bytes\": {}, \"used_bytes\": {}}},",
+               memory.block_count, memory.allocation_count,
+               memory.reserved_bytes, memory.used_bytes);
+  std::print("  \"gpu_ms\": {{");
+  bool first = true;
+  for (const auto &scope : renderer.gpu_profiler().stats()) {
+    std::print("{}\"{}\": {{\"avg\": {:.4f}, \"max\": {:.4f}}}",
+               first ? "" : ", ", scope.name, scope.avg_ms, scope.max_ms);
+    first = false;
+  }
+  std::println("}}");
+  std::println("}}");
+} catch (const engine::exceptions::EngineError &e) {
+  std::println(stderr, "[ENGINE ERROR]\t {}", e.what());
+  return 1;
+} catch (const std::exception &e) {
+  std::println(stderr, "[UNHANDLED EXCEPTION]\t {}", e.what());
+  return 1;
+}
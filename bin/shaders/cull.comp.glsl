@@ -0,0 +1,72 @@
+#version 460
+
+// work group size is specialization constant 0
+layout(local_size_x_id = 0) in;
+
+// matches VkDrawIndexedIndirectCommand
+struct DrawCommand {
+    uint index_count;
+    uint instance_count;
+    uint first_index;
+    int vertex_offset;
+    uint first_instance;
+};
+
+// one per instance of a culled draw
+struct Record {
+    uint instance; // into the frame's instance data
+    uint command;  // the draw it belongs to
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer Instances {
+    mat4 transforms[];
+};
+
+layout(std430, set = 0, binding = 1) readonly buffer Records {
+    Record records[];
+};
+
+layout(std430, set = 0, binding = 2) readonly buffer Bounds {
+    vec4 bounding_spheres[]; // per command, mesh space center and radius
+};
+
+// instance counts start at zero, survivors are counted in
+layout(std430, set = 0, binding = 3) buffer Commands {
+    DrawCommand commands[];
+};
+
+// survivors of a command are compacted from its first instance on
+layout(std430, set = 0, binding = 4) writeonly buffer Visible {
+    uint visible[];
+};
+
+layout(std140, set = 0, binding = 5) uniform Frustum {
+    vec4 planes[6]; // normalized, pointing inside
+};
+
+layout(push_constant) uniform Constants {
+    uint record_count;
+} constants;
+
+void main() {
+    const uint i = gl_GlobalInvocationID.x;
+    if (i >= constants.record_count) {
+        return;
+    }
+
+    const Record record = records[i];
+    const vec4 bounding_sphere = bounding_spheres[record.command];
+    const mat4 transform = transforms[record.instance];
+    const vec3 center = (transform * vec4(bounding_sphere.xyz, 1.0f)).xyz;
+    const float scale = max(max(length(transform[0].xyz), length(transform[1].xyz)),
+                            length(transform[2].xyz));
+    const float radius = bounding_sphere.w * scale;
+    for (int p = 0; p < 6; ++p) {
+        if (dot(planes[p].xyz, center) + planes[p].w < -radius) {
+            return;
+        }
+    }
+
+    const uint slot = atomicAdd(commands[record.command].instance_count, 1);
+    visible[commands[record.command].first_instance + slot] = record.instance;
+}
@@ -0,0 +1,29 @@
+#version 460
+
+layout(location = 0) in vec3 in_position;
+layout(location = 1) in vec2 in_uv;
+layout(location = 2) in vec3 in_normal;
+layout(location = 3) in vec3 in_color;
+
+layout(location = 0) out vec4 frag_color;
+
+// the renderer's instance set: every InstanceData of the frame and, per
+// drawn instance, which of them it is; culling compacts the latter
+layout(std430, set = 0, binding = 0) readonly buffer Instances {
+    mat4 transforms[];
+};
+
+layout(std430, set = 0, binding = 1) readonly buffer Visible {
+    uint visible[];
+};
+
+layout(push_constant) uniform PushConstants {
+    mat4 view_projection;
+    float time;
+} constants;
+
+void main() {
+    const mat4 transform = transforms[visible[gl_InstanceIndex]];
+    gl_Position = constants.view_projection * transform * vec4(in_position, 1.0f);
+    frag_color = vec4(in_color, 1.0f) + vec4(vec3(abs(sin(constants.time) / 4.0f)), 0.0f);
+}
@@ -1,15 +1,64 @@
 #include "application.hpp"
 #include "SDL3/SDL_events.h"  // for SDL_EventType, SDL_PollEvent, SDL_Event
-#include "SDL3/SDL_keycode.h" // for SDLK_ESCAPE
+#include "SDL3/SDL_keycode.h" // for SDLK_ESCAPE, SDLK_F11, SDLK_F12
+#include "cpu_profiler.hpp"   // for CpuProfiler, CpuScope
+#include "meta.hpp"           // for CPU_TRACE_PATH
+#include "swapchain.hpp"      // for PresentPolicy, present_mode_name
+#include <cstdio>             // for stderr
+#include <print>              // for println
 
 namespace engine {
 
-Application::Application() : m_renderer(m_window) {}
+namespace {
+
+void dump_cpu_trace() {
+  if (core::CpuProfiler::instance().write_chrome_trace(core::CPU_TRACE_PATH)) {
+    std::println(stderr, "CPU trace written to {}",
+                 core::CPU_TRACE_PATH.string());
+  } else {
+    std::println(stderr, "WARNING: failed to write CPU trace to {}",
+                 core::CPU_TRACE_PATH.string());
+  }
+}
+
+// F11 walks through the present modes to compare latency and throughput
+void switch_present_mode(core::Renderer &renderer) {
+  using enum core::PresentPolicy::Mode;
+  core::PresentPolicy policy = renderer.present_policy();
+  switch (policy.mode) {
+  case VSYNC:
+    policy.mode = LOW_LATENCY;
+    break;
+  case LOW_LATENCY:
+    policy.mode = IMMEDIATE;
+    break;
+  case IMMEDIATE:
+    policy.mode = RELAXED_VSYNC;
+    break;
+  case RELAXED_VSYNC:
+    policy.mode = VSYNC;
+    break;
+  }
+  renderer.set_present_policy(policy);
+  std::println(stderr, "present mode: {}, {} swapchain images",
+               core::present_mode_name(renderer.swapchain().present_mode()),
+               renderer.swapchain().image_count());
+}
+
+} // namespace
+
+Application::Application(const core::PresentPolicy &present_policy)
+    : m_renderer(m_window, present_policy) {
+  // the main thread records alongside the workers
+  m_renderer.set_job_system(&m_jobs);
+  m_renderer.set_recording_threads(m_jobs.size() + 1);
+}
 
 void Application::run() {
   SDL_Event ev;
   bool quit = false;
   while (!quit) {
+    const core::CpuScope frame_scope("frame");
     while (SDL_PollEvent(&ev)) {
       if (ev.type == SDL_EVENT_QUIT) {
         quit = true;
@@ -19,6 +68,11 @@ void Application::run() {
         m_window.height = ev.window.data2;
       } else if (ev.type == SDL_EVENT_KEY_DOWN) {
         quit = ev.key.key == SDLK_ESCAPE;
+        if (ev.key.key == SDLK_F11) {
+          switch_present_mode(m_renderer);
+        } else if (ev.key.key == SDLK_F12) {
+          dump_cpu_trace();
+        }
       }
     }
 
@@ -27,11 +81,16 @@ void Application::run() {
     }
 
     m_renderer.render_frame();
+    m_jobs.poll_errors();
     for (auto &object : m_render_objects) {
+      const core::CpuScope object_scope("on_render_frame");
       object->on_render_frame();
     }
   }
   m_renderer.wait_idle();
+  if (m_trace_on_exit && core::CpuProfiler::instance().enabled()) {
+    dump_cpu_trace();
+  }
 }
 
 /*Application::~Application() {}*/
@@ -1,7 +1,9 @@
 #pragma once
 
+#include "job_system.hpp"    // for JobSystem
 #include "render_object.hpp" // for RenderObject
 #include "renderer.hpp"      // for Renderer
+#include "swapchain.hpp"     // for PresentPolicy
 #include "window.hpp"        // for Window
 #include <concepts>          // for derived_from
 #include <functional>        // for ref
@@ -13,15 +15,26 @@ namespace engine {
 
 class Application {
 private:
+  // declared first: the renderer submits to it until destroyed
+  core::JobSystem m_jobs;
   core::Window m_window;
   core::Renderer m_renderer;
   std::vector<std::unique_ptr<RenderObject>> m_render_objects;
+  bool m_trace_on_exit = false;
 
 public:
-  Application();
+  explicit Application(const core::PresentPolicy &present_policy = {});
   void run();
   ~Application() = default;
 
+  // shared by the renderer, asset loading and object updates; events and
+  // `RenderObject::on_render_frame` stay on the main thread, which may
+  // spread its work with `parallel_for` or submit jobs of its own
+  [[nodiscard]] core::JobSystem &jobs() { return m_jobs; }
+
+  // writes the CPU trace when `run` returns; F12 writes it at any time
+  void set_trace_on_exit(bool trace) { m_trace_on_exit = trace; }
+
   template <typename T, typename... Args>
     requires std::derived_from<T, RenderObject>
   auto add_render_object(Args &&...args)
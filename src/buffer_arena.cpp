@@ -0,0 +1,105 @@
+#include "buffer_arena.hpp"
+#include "cpu_profiler.hpp"      // for CpuScope
+#include "engine_exceptions.hpp" // for MemoryAllocationError
+#include "queue.hpp"             // for CommandQueue
+#include "renderer.hpp"          // for Renderer
+#include "upload_scheduler.hpp"  // for UploadHandle
+#include <algorithm>             // for max
+#include <array>                 // for array
+#include <cassert>               // for assert
+
+namespace engine::core {
+
+ArenaRange &ArenaRange::operator=(ArenaRange &&other) noexcept {
+  if (this != &other) {
+    std::swap(m_arena, other.m_arena);
+    std::swap(m_page, other.m_page);
+    std::swap(m_buffer, other.m_buffer);
+    std::swap(m_offset, other.m_offset);
+    std::swap(m_size, other.m_size);
+    std::swap(m_range_offset, other.m_range_offset);
+    std::swap(m_range_size, other.m_range_size);
+  }
+  return *this;
+}
+
+ArenaRange::~ArenaRange() {
+  if (m_arena != nullptr && m_page != nullptr) {
+    m_arena->free(*this);
+  }
+}
+
+UploadHandle ArenaRange::upload_staged(std::span<const std::byte> data) {
+  assert(data.size() <= m_size);
+  return m_buffer->upload_staged(data, m_offset);
+}
+
+BufferArena::BufferArena(Renderer &renderer, VkBufferUsageFlags usage,
+                         VkDeviceSize page_size)
+    : m_renderer(&renderer), m_usage(usage), m_page_size(page_size) {}
+
+BufferArena::Page &BufferArena::make_page(VkDeviceSize size) {
+  const CpuScope scope("make arena page");
+  const std::array<unsigned, 2> families = {
+      m_renderer->queue(CommandQueue::Kind::GRAPHICS).index(),
+      m_renderer->queue(CommandQueue::Kind::TRANSFER).index()};
+  const bool concurrent = families[0] != families[1];
+
+  auto page = std::make_unique<Page>();
+  page->buffer =
+      Buffer(*m_renderer, size, m_usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+             concurrent ? VK_SHARING_MODE_CONCURRENT
+                        : VK_SHARING_MODE_EXCLUSIVE,
+             concurrent ? static_cast<unsigned>(families.size()) : 0,
+             concurrent ? families.data() : nullptr);
+  page->buffer.allocate(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+  page->free_list = FreeList(size);
+  return *m_pages.emplace_back(std::move(page));
+}
+
+ArenaRange BufferArena::allocate(VkDeviceSize size, VkDeviceSize alignment) {
+  // empty meshes still get a distinct, valid offset
+  size = std::max<VkDeviceSize>(size, 1);
+
+  const std::lock_guard lock(m_mutex);
+  ArenaRange range;
+  const auto take = [this, &range, size, alignment](Page &page) {
+    const auto taken = page.free_list.allocate(size, alignment);
+    if (!taken) {
+      return false;
+    }
+    range.m_arena = this;
+    range.m_page = &page;
+    range.m_buffer = &page.buffer;
+    range.m_offset = taken->offset;
+    range.m_size = size;
+    range.m_range_offset = taken->range_offset;
+    range.m_range_size = taken->range_size;
+    return true;
+  };
+
+  for (auto &page : m_pages) {
+    if (take(*page)) {
+      return range;
+    }
+  }
+  if (!take(make_page(std::max(size, m_page_size)))) {
+    throw exceptions::MemoryAllocationError{};
+  }
+  return range;
+}
+
+std::size_t BufferArena::page_count() const {
+  const std::lock_guard lock(m_mutex);
+  return m_pages.size();
+}
+
+void BufferArena::free(ArenaRange &range) {
+  const std::lock_guard lock(m_mutex);
+  static_cast<Page *>(range.m_page)
+      ->free_list.release(range.m_range_offset, range.m_range_size);
+  range.m_arena = nullptr;
+  range.m_page = nullptr;
+}
+
+} // namespace engine::core
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "memory_allocator.hpp" // for FreeList
+#include "vulkan_buffers.hpp"   // for Buffer
+#include <cstddef>              // for byte, size_t
+#include <memory>               // for unique_ptr
+#include <mutex>                // for mutex
+#include <span>                 // for span
+#include <utility>              // for move
+#include <vector>               // for vector
+#include <vulkan/vulkan_core.h> // for VkBuffer, VkDeviceSize
+
+namespace engine::core {
+
+class BufferArena;
+class Renderer;
+class UploadHandle;
+
+// Sub-range of one of an arena's buffers. Returns the range to the arena on
+// destruction, so owners (e.g. `Mesh`) only have to keep it alive.
+class ArenaRange {
+private:
+  friend class BufferArena;
+
+  BufferArena *m_arena = nullptr;
+  void *m_page = nullptr;
+  Buffer *m_buffer = nullptr;
+  VkDeviceSize m_offset = 0;
+  VkDeviceSize m_size = 0;
+  // range actually taken from the page, including alignment padding
+  VkDeviceSize m_range_offset = 0;
+  VkDeviceSize m_range_size = 0;
+
+public:
+  ArenaRange() = default;
+
+  [[nodiscard]] VkBuffer buffer() const {
+    return m_buffer != nullptr ? m_buffer->buffer() : VK_NULL_HANDLE;
+  }
+  [[nodiscard]] VkDeviceSize offset() const { return m_offset; }
+  [[nodiscard]] VkDeviceSize size() const { return m_size; }
+
+  // schedules a copy of `data` to the start of the range, see
+  // `Buffer::upload_staged`
+  UploadHandle upload_staged(std::span<const std::byte> data);
+
+  ArenaRange(const ArenaRange &) = delete;
+  ArenaRange &operator=(const ArenaRange &) = delete;
+
+  ArenaRange(ArenaRange &&other) noexcept { *this = std::move(other); }
+
+  ArenaRange &operator=(ArenaRange &&other) noexcept;
+
+  ~ArenaRange();
+};
+
+// Shared device local buffers that meshes sub-allocate their vertices or
+// indices from, so that draws of different meshes bind the same buffer and
+// tell their data apart by firstIndex and vertexOffset. Pages are created on
+// demand and kept for the arena's lifetime; requests bigger than a page get
+// one of their own, exactly sized. With a separate transfer family pages are
+// shared concurrently, so uploads into one range never need an ownership
+// transfer of a buffer other draws are reading from.
+class BufferArena {
+public:
+  static constexpr VkDeviceSize DEFAULT_PAGE_SIZE = 32ull << 20;
+
+  BufferArena(Renderer &renderer, VkBufferUsageFlags usage,
+              VkDeviceSize page_size = DEFAULT_PAGE_SIZE);
+
+  // `alignment` need not be a power of two, vertex ranges are aligned to
+  // the vertex size so their offset is a whole vertexOffset
+  [[nodiscard]] ArenaRange allocate(VkDeviceSize size, VkDeviceSize alignment);
+
+  [[nodiscard]] std::size_t page_count() const;
+
+  BufferArena(const BufferArena &) = delete;
+  BufferArena(BufferArena &&) noexcept = delete;
+  BufferArena &operator=(const BufferArena &) = delete;
+  BufferArena &operator=(BufferArena &&) noexcept = delete;
+  ~BufferArena() = default;
+
+private:
+  friend class ArenaRange;
+
+  struct Page {
+    Buffer buffer;
+    FreeList free_list;
+  };
+
+  Renderer *m_renderer = nullptr;
+  VkBufferUsageFlags m_usage = 0;
+  VkDeviceSize m_page_size = DEFAULT_PAGE_SIZE;
+  std::vector<std::unique_ptr<Page>> m_pages;
+  mutable std::mutex m_mutex;
+
+  Page &make_page(VkDeviceSize size);
+  void free(ArenaRange &range);
+};
+
+} // namespace engine::core
@@ -7,7 +7,8 @@
 namespace engine::core {
 
 CommandPool::CommandPool(VkDevice device, VkPhysicalDevice physical_device,
-                         VkSurfaceKHR surface, bool is_transfer)
+                         VkSurfaceKHR surface, bool is_transfer,
+                         VkCommandPoolCreateFlags flags)
     : m_device(device) {
   unsigned index = std::numeric_limits<unsigned>::max();
   if (!is_transfer) {
@@ -23,7 +24,7 @@ CommandPool::CommandPool(VkDevice device, VkPhysicalDevice physical_device,
   const VkCommandPoolCreateInfo create_info{
       .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
       .pNext = nullptr,
-      .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+      .flags = flags,
       .queueFamilyIndex = index};
 
   VkCommandPool command_pool = VK_NULL_HANDLE;
@@ -35,13 +36,14 @@ CommandPool::CommandPool(VkDevice device, VkPhysicalDevice physical_device,
 }
 
 [[nodiscard]] std::vector<CommandBuffer>
-CommandPool::make_command_buffers(std::size_t count) const {
+CommandPool::make_command_buffers(std::size_t count,
+                                  VkCommandBufferLevel level) const {
   std::vector<VkCommandBuffer> vk_command_buffers(count);
   const VkCommandBufferAllocateInfo allocate_info{
       .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
       .pNext = nullptr,
       .commandPool = m_command_pool,
-      .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+      .level = level,
       .commandBufferCount = static_cast<unsigned>(vk_command_buffers.size())};
 
   if (vkAllocateCommandBuffers(m_device, &allocate_info,
@@ -56,4 +58,13 @@ CommandPool::make_command_buffers(std::size_t count) const {
   return command_buffers;
 }
 
+CommandBuffer CommandPool::acquire_one_shot() {
+  if (m_recycled.empty()) {
+    return make_command_buffers(1).front();
+  }
+  const CommandBuffer buffer = m_recycled.back();
+  m_recycled.pop_back();
+  return buffer;
+}
+
 } // namespace engine::core
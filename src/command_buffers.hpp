@@ -21,13 +21,15 @@ public:
     vkResetCommandBuffer(m_command_buffer, flags);
   }
 
+  // secondary command buffers need `inheritance`
   void record(const std::invocable<VkCommandBuffer> auto &function,
-              unsigned flags = 0) {
+              unsigned flags = 0,
+              const VkCommandBufferInheritanceInfo *inheritance = nullptr) {
     const VkCommandBufferBeginInfo command_buffer_begin{
         .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
         .pNext = nullptr,
         .flags = flags,
-        .pInheritanceInfo = nullptr};
+        .pInheritanceInfo = inheritance};
 
     if (vkBeginCommandBuffer(m_command_buffer, &command_buffer_begin) !=
         VK_SUCCESS) {
@@ -48,13 +50,28 @@ class CommandPool {
 private:
   VkDestroyable<VkCommandPoolWrapper> m_command_pool;
   VkDevice m_device;
+  std::vector<CommandBuffer> m_recycled;
 
 public:
+  // buffers of pools without VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT
+  // are only reset all at once, through `reset`
   CommandPool(VkDevice device, VkPhysicalDevice physical_device,
-              VkSurfaceKHR surface, bool is_transfer = false);
-
-  [[nodiscard]] std::vector<CommandBuffer>
-  make_command_buffers(std::size_t count) const;
+              VkSurfaceKHR surface, bool is_transfer = false,
+              VkCommandPoolCreateFlags flags =
+                  VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+
+  // none of the pool's buffers may be pending execution
+  void reset() { vkResetCommandPool(m_device, m_command_pool, 0); }
+
+  // primary buffer for a one-off submit; `recycle` it once the GPU is done
+  // with it instead of freeing. Relies on beginning it resetting it, so the
+  // pool needs VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT
+  [[nodiscard]] CommandBuffer acquire_one_shot();
+  void recycle(CommandBuffer buffer) { m_recycled.push_back(buffer); }
+
+  [[nodiscard]] std::vector<CommandBuffer> make_command_buffers(
+      std::size_t count,
+      VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY) const;
 
   void free_command_buffers(const std::vector<CommandBuffer> &buffers) const {
     vkFreeCommandBuffers(
@@ -0,0 +1,149 @@
+#include "compute_pipeline.hpp"
+#include "engine_exceptions.hpp" // for ComputePipelineCreationError, Desc...
+#include "shader.hpp"            // for Shader
+#include <cassert>               // for assert
+#include <memory>                // for make_shared
+#include <vector>                // for vector
+
+namespace engine::core {
+
+VkDestroyable<VkDescriptorSetLayoutWrapper>
+DescriptorSetLayoutMaker::make_descriptor_set_layout() const {
+  const VkDescriptorSetLayoutCreateInfo create_info{
+      .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = 0,
+      .bindingCount = static_cast<unsigned>(m_bindings.size()),
+      .pBindings = m_bindings.data()};
+  VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+  if (vkCreateDescriptorSetLayout(m_device, &create_info, nullptr, &layout) !=
+      VK_SUCCESS) {
+    throw exceptions::DescriptorSetLayoutCreationError{};
+  }
+  return {layout, m_device};
+}
+
+ComputePipelineMaker &
+ComputePipelineMaker::set_shader(const std::filesystem::path &path) {
+  m_shader = m_shader_cache ? m_shader_cache->get(path)
+                            : std::make_shared<const Shader>(m_device, path);
+  return *this;
+}
+
+VkDestroyable<VkPipelineWrapper>
+ComputePipelineMaker::make_compute_pipeline(VkPipelineCache cache) const {
+  assert(m_shader && m_pipeline_layout != VK_NULL_HANDLE);
+  const VkSpecializationInfo specialization{
+      .mapEntryCount = static_cast<unsigned>(m_specialization_entries.size()),
+      .pMapEntries = m_specialization_entries.data(),
+      .dataSize = m_specialization_data.size(),
+      .pData = m_specialization_data.data()};
+
+  const VkComputePipelineCreateInfo create_info{
+      .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = 0,
+      .stage = {.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                .pNext = nullptr,
+                .flags = 0,
+                .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+                .module = m_shader->get_module(),
+                .pName = "main",
+                .pSpecializationInfo = m_specialization_entries.empty()
+                                           ? nullptr
+                                           : &specialization},
+      .layout = m_pipeline_layout,
+      .basePipelineHandle = VK_NULL_HANDLE,
+      .basePipelineIndex = 0};
+
+  VkPipeline pipeline = VK_NULL_HANDLE;
+  if (vkCreateComputePipelines(m_device, cache, 1, &create_info, nullptr,
+                               &pipeline) != VK_SUCCESS) {
+    throw exceptions::ComputePipelineCreationError{};
+  }
+  return {pipeline, m_device};
+}
+
+ComputeRecorder &
+ComputeRecorder::bind(VkPipeline pipeline, VkPipelineLayout layout,
+                      std::span<const VkDescriptorSet> sets) {
+  m_layout = layout;
+  vkCmdBindPipeline(m_command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                    pipeline);
+  if (!sets.empty()) {
+    vkCmdBindDescriptorSets(m_command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                            layout, 0, static_cast<unsigned>(sets.size()),
+                            sets.data(), 0, nullptr);
+  }
+  return *this;
+}
+
+ComputeRecorder &
+ComputeRecorder::barrier(std::initializer_list<Consumer> consumers,
+                         std::initializer_list<VkBuffer> buffers) {
+  // a zero destination stage mask is invalid
+  assert(consumers.size() != 0);
+  VkPipelineStageFlags stages = 0;
+  VkAccessFlags access = 0;
+  for (const Consumer consumer : consumers) {
+    switch (consumer) {
+    case Consumer::INDIRECT_DRAW:
+      stages |= VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
+      access |= VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+      break;
+    case Consumer::VERTEX_INPUT:
+      stages |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+      access |= VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+      break;
+    case Consumer::VERTEX_SHADER:
+      stages |= VK_PIPELINE_STAGE_VERTEX_SHADER_BIT;
+      access |= VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT;
+      break;
+    case Consumer::FRAGMENT_SHADER:
+      stages |= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+      access |= VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT;
+      break;
+    case Consumer::COMPUTE:
+      stages |= VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+      access |= VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+      break;
+    case Consumer::TRANSFER:
+      stages |= VK_PIPELINE_STAGE_TRANSFER_BIT;
+      access |= VK_ACCESS_TRANSFER_READ_BIT;
+      break;
+    }
+  }
+
+  // without buffers every write of the dispatches is made visible
+  if (buffers.size() == 0) {
+    const VkMemoryBarrier barrier{.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                                  .pNext = nullptr,
+                                  .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+                                  .dstAccessMask = access};
+    vkCmdPipelineBarrier(m_command_buffer,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, stages, 0, 1,
+                         &barrier, 0, nullptr, 0, nullptr);
+    return *this;
+  }
+
+  std::vector<VkBufferMemoryBarrier> barriers;
+  barriers.reserve(buffers.size());
+  for (VkBuffer buffer : buffers) {
+    barriers.push_back({.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+                        .pNext = nullptr,
+                        .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+                        .dstAccessMask = access,
+                        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                        .buffer = buffer,
+                        .offset = 0,
+                        .size = VK_WHOLE_SIZE});
+  }
+  vkCmdPipelineBarrier(m_command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                       stages, 0, 0, nullptr,
+                       static_cast<unsigned>(barriers.size()), barriers.data(),
+                       0, nullptr);
+  return *this;
+}
+
+} // namespace engine::core
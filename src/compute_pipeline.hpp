@@ -0,0 +1,138 @@
+#pragma once
+
+#include "shader_cache.hpp"       // for ShaderCache, SharedShader
+#include "vulkan_destroyable.hpp" // for VkDestroyable, VkPipelineWrapper
+#include <cstddef>                // for byte, size_t
+#include <cstring>                // for memcpy
+#include <filesystem>             // for path
+#include <initializer_list>       // for initializer_list
+#include <span>                   // for span
+#include <type_traits>            // for is_trivially_copyable_v
+#include <vector>                 // for vector
+#include <vulkan/vulkan_core.h>   // for VkDevice, VkPipelineLayout
+
+namespace engine::core {
+
+class DescriptorSetLayoutMaker {
+private:
+  std::vector<VkDescriptorSetLayoutBinding> m_bindings;
+  VkDevice m_device = VK_NULL_HANDLE;
+
+public:
+  DescriptorSetLayoutMaker(VkDevice device) : m_device(device) {}
+
+  DescriptorSetLayoutMaker &add_binding(unsigned binding,
+                                        VkDescriptorType type,
+                                        VkShaderStageFlags stages,
+                                        unsigned count = 1) {
+    m_bindings.push_back({.binding = binding,
+                          .descriptorType = type,
+                          .descriptorCount = count,
+                          .stageFlags = stages,
+                          .pImmutableSamplers = nullptr});
+    return *this;
+  }
+
+  [[nodiscard]] VkDestroyable<VkDescriptorSetLayoutWrapper>
+  make_descriptor_set_layout() const;
+
+  [[nodiscard]] std::span<const VkDescriptorSetLayoutBinding> bindings() const {
+    return m_bindings;
+  }
+};
+
+class ComputePipelineMaker {
+private:
+  SharedShader m_shader;
+  std::vector<VkSpecializationMapEntry> m_specialization_entries;
+  std::vector<std::byte> m_specialization_data;
+  VkPipelineLayout m_pipeline_layout = VK_NULL_HANDLE;
+  VkDevice m_device = VK_NULL_HANDLE;
+  ShaderCache *m_shader_cache = nullptr;
+
+public:
+  // without a cache the maker loads and owns its shader module
+  ComputePipelineMaker(VkDevice device, ShaderCache *shader_cache = nullptr)
+      : m_device(device), m_shader_cache(shader_cache) {}
+
+  ComputePipelineMaker &set_shader(const std::filesystem::path &path);
+
+  // e.g. `layout(local_size_x_id = 0) in;` takes constant 0 as work group
+  // size; `T` must match the shader's type, bool constants are 32-bit
+  template <typename T>
+    requires std::is_trivially_copyable_v<T>
+  ComputePipelineMaker &set_specialization_constant(unsigned id,
+                                                    const T &value) {
+    const std::size_t offset = m_specialization_data.size();
+    m_specialization_data.resize(offset + sizeof(T));
+    std::memcpy(m_specialization_data.data() + offset, &value, sizeof(T));
+    m_specialization_entries.push_back(
+        {.constantID = id,
+         .offset = static_cast<unsigned>(offset),
+         .size = sizeof(T)});
+    return *this;
+  }
+
+  ComputePipelineMaker &set_pipeline_layout(VkPipelineLayout layout) {
+    m_pipeline_layout = layout;
+    return *this;
+  }
+
+  [[nodiscard]] VkDestroyable<VkPipelineWrapper>
+  make_compute_pipeline(VkPipelineCache cache = VK_NULL_HANDLE) const;
+};
+
+// Records compute work into a command buffer, outside of render passes.
+class ComputeRecorder {
+public:
+  // what reads the results of preceding dispatches
+  enum class Consumer {
+    INDIRECT_DRAW,   // indirect commands and counts
+    VERTEX_INPUT,    // vertex and index buffers
+    VERTEX_SHADER,   // storage and uniform reads
+    FRAGMENT_SHADER, // storage and uniform reads
+    COMPUTE,         // following dispatches, read and write
+    TRANSFER,        // copies out of the results
+  };
+
+private:
+  VkCommandBuffer m_command_buffer = VK_NULL_HANDLE;
+  VkPipelineLayout m_layout = VK_NULL_HANDLE;
+
+public:
+  explicit ComputeRecorder(VkCommandBuffer command_buffer)
+      : m_command_buffer(command_buffer) {}
+
+  ComputeRecorder &bind(VkPipeline pipeline, VkPipelineLayout layout,
+                        std::span<const VkDescriptorSet> sets = {});
+
+  // uses the layout given to the last `bind`
+  template <typename T>
+    requires std::is_trivially_copyable_v<T>
+  ComputeRecorder &push_constants(const T &data, unsigned offset = 0) {
+    vkCmdPushConstants(m_command_buffer, m_layout, VK_SHADER_STAGE_COMPUTE_BIT,
+                       offset, sizeof(T), &data);
+    return *this;
+  }
+
+  ComputeRecorder &dispatch(unsigned groups_x, unsigned groups_y = 1,
+                            unsigned groups_z = 1) {
+    vkCmdDispatch(m_command_buffer, groups_x, groups_y, groups_z);
+    return *this;
+  }
+
+  // enough groups of `group_size` for `invocations` in one dimension
+  ComputeRecorder &dispatch_invocations(unsigned invocations,
+                                        unsigned group_size) {
+    return dispatch((invocations + group_size - 1) / group_size);
+  }
+
+  // makes writes of preceding dispatches to `buffers`, or to any memory when
+  // none are given, visible to `consumers`, of which there must be at least
+  // one. Images read by graphics need a layout transition, which this does
+  // not do
+  ComputeRecorder &barrier(std::initializer_list<Consumer> consumers,
+                           std::initializer_list<VkBuffer> buffers);
+};
+
+} // namespace engine::core
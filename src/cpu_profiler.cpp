@@ -0,0 +1,116 @@
+#include "cpu_profiler.hpp"
+#include <algorithm> // for max
+#include <format>    // for format_to
+#include <fstream>   // for ofstream
+#include <iterator>  // for ostreambuf_iterator
+#include <string>    // for string
+#include <vector>    // for vector
+
+namespace engine::core {
+
+namespace {
+
+// slots this close to being overwritten are not exported, their fields may
+// change while being read
+constexpr std::uint64_t EXPORT_MARGIN = 1024;
+
+struct ExportedEvent {
+  const char *name;
+  std::uint64_t start_ns;
+  std::uint64_t duration_ns;
+};
+
+void write_json_string(std::ofstream &file, const char *text) {
+  file << '"';
+  for (; *text != '\0'; ++text) {
+    if (*text == '"' || *text == '\\') {
+      file << '\\';
+    }
+    file << *text;
+  }
+  file << '"';
+}
+
+} // namespace
+
+CpuProfiler &CpuProfiler::instance() {
+  static CpuProfiler profiler;
+  return profiler;
+}
+
+CpuProfiler::ThreadBuffer &CpuProfiler::thread_buffer() {
+  thread_local ThreadBuffer *buffer = nullptr;
+  if (buffer == nullptr) {
+    const std::lock_guard lock(m_buffers_mutex);
+    m_buffers.push_back(std::make_unique<ThreadBuffer>());
+    buffer = m_buffers.back().get();
+    buffer->thread_index = static_cast<std::uint32_t>(m_buffers.size());
+  }
+  return *buffer;
+}
+
+void CpuProfiler::record(const char *name, std::uint64_t start_ns,
+                         std::uint64_t end_ns) {
+  ThreadBuffer &buffer = thread_buffer();
+  const std::uint64_t head = buffer.head.load(std::memory_order_relaxed);
+  Event &event = buffer.events[head % EVENTS_PER_THREAD];
+  event.name.store(name, std::memory_order_relaxed);
+  event.start_ns.store(start_ns, std::memory_order_relaxed);
+  event.duration_ns.store(end_ns - start_ns, std::memory_order_relaxed);
+  buffer.head.store(head + 1, std::memory_order_release);
+}
+
+bool CpuProfiler::write_chrome_trace(const std::filesystem::path &path) const {
+  std::ofstream file(path, std::ios::trunc);
+  if (!file) {
+    return false;
+  }
+
+  const std::lock_guard lock(m_buffers_mutex);
+  file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool first = true;
+  std::vector<ExportedEvent> events;
+  for (const auto &buffer : m_buffers) {
+    std::format_to(std::ostreambuf_iterator<char>(file),
+                   "{}{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+                   "\"tid\":{},\"args\":{{\"name\":\"thread {}\"}}}}",
+                   first ? "" : ",", buffer->thread_index,
+                   buffer->thread_index);
+    first = false;
+
+    const std::uint64_t head = buffer->head.load(std::memory_order_acquire);
+    const std::uint64_t oldest =
+        head > EVENTS_PER_THREAD - EXPORT_MARGIN
+            ? head - (EVENTS_PER_THREAD - EXPORT_MARGIN)
+            : 0;
+    events.clear();
+    for (std::uint64_t i = oldest; i < head; ++i) {
+      const Event &event = buffer->events[i % EVENTS_PER_THREAD];
+      events.push_back({event.name.load(std::memory_order_relaxed),
+                        event.start_ns.load(std::memory_order_relaxed),
+                        event.duration_ns.load(std::memory_order_relaxed)});
+    }
+    // drop whatever the owner overwrote while we were copying
+    const std::uint64_t new_head = buffer->head.load(std::memory_order_acquire);
+    const std::uint64_t valid_from =
+        new_head > EVENTS_PER_THREAD ? new_head - EVENTS_PER_THREAD : 0;
+    const std::size_t skip =
+        static_cast<std::size_t>(std::max(valid_from, oldest) - oldest);
+
+    for (std::size_t i = skip; i < events.size(); ++i) {
+      file << ",{\"name\":";
+      write_json_string(file, events[i].name);
+      // chrome trace timestamps are in microseconds
+      std::format_to(std::ostreambuf_iterator<char>(file),
+                     ",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},"
+                     "\"dur\":{:.3f}}}",
+                     buffer->thread_index,
+                     static_cast<double>(events[i].start_ns) / 1000.0,
+                     static_cast<double>(events[i].duration_ns) / 1000.0);
+    }
+  }
+  file << "]}\n";
+  return static_cast<bool>(file);
+}
+
+} // namespace engine::core
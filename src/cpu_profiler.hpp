@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>     // for atomic
+#include <chrono>     // for steady_clock
+#include <cstddef>    // for size_t
+#include <cstdint>    // for uint32_t, uint64_t
+#include <filesystem> // for path
+#include <memory>     // for unique_ptr
+#include <mutex>      // for mutex
+#include <vector>     // for vector
+
+namespace engine::core {
+
+// Process-wide CPU timeline. Every thread records into its own ring buffer
+// without locks, the oldest events get overwritten. The timeline is written
+// as Chrome trace JSON, which chrome://tracing and Perfetto open.
+class CpuProfiler {
+public:
+  static constexpr std::size_t EVENTS_PER_THREAD = std::size_t{1} << 16;
+
+  static CpuProfiler &instance();
+
+  void set_enabled(bool enabled) {
+    m_enabled.store(enabled, std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] bool enabled() const {
+    return m_enabled.load(std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] std::uint64_t now_ns() const {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - m_start)
+            .count());
+  }
+
+  // `name` must outlive the profiler, string literals are intended
+  void record(const char *name, std::uint64_t start_ns, std::uint64_t end_ns);
+
+  // may run while other threads keep recording, returns false on io failure
+  bool write_chrome_trace(const std::filesystem::path &path) const;
+
+  CpuProfiler(const CpuProfiler &) = delete;
+  CpuProfiler(CpuProfiler &&) noexcept = delete;
+  CpuProfiler &operator=(const CpuProfiler &) = delete;
+  CpuProfiler &operator=(CpuProfiler &&) noexcept = delete;
+  ~CpuProfiler() = default;
+
+private:
+  // fields are atomics only so that a concurrent export is not a data race,
+  // the owning thread is the only writer
+  struct Event {
+    std::atomic<const char *> name = nullptr;
+    std::atomic<std::uint64_t> start_ns = 0;
+    std::atomic<std::uint64_t> duration_ns = 0;
+  };
+
+  struct ThreadBuffer {
+    std::uint32_t thread_index = 0;
+    std::unique_ptr<Event[]> events =
+        std::make_unique<Event[]>(EVENTS_PER_THREAD);
+    std::atomic<std::uint64_t> head = 0; // events ever written
+  };
+
+  std::chrono::steady_clock::time_point m_start =
+      std::chrono::steady_clock::now();
+  std::atomic<bool> m_enabled = true;
+
+  // buffers outlive their threads, so exits of workers lose nothing
+  mutable std::mutex m_buffers_mutex;
+  std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+
+  CpuProfiler() = default;
+
+  ThreadBuffer &thread_buffer();
+};
+
+// Records the time between construction and destruction.
+class CpuScope {
+private:
+  const char *m_name = nullptr;
+  std::uint64_t m_start_ns = 0;
+  bool m_active = false;
+
+public:
+  explicit CpuScope(const char *name)
+      : m_name(name), m_active(CpuProfiler::instance().enabled()) {
+    if (m_active) {
+      m_start_ns = CpuProfiler::instance().now_ns();
+    }
+  }
+
+  CpuScope(const CpuScope &) = delete;
+  CpuScope(CpuScope &&) noexcept = delete;
+  CpuScope &operator=(const CpuScope &) = delete;
+  CpuScope &operator=(CpuScope &&) noexcept = delete;
+
+  ~CpuScope() {
+    if (m_active) {
+      CpuProfiler &profiler = CpuProfiler::instance();
+      profiler.record(m_name, m_start_ns, profiler.now_ns());
+    }
+  }
+};
+
+} // namespace engine::core
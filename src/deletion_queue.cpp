@@ -0,0 +1,16 @@
+#include "deletion_queue.hpp"
+#include <algorithm> // for find_if
+
+namespace engine::core {
+
+void DeletionQueue::collect(std::size_t completed_frames) {
+  const auto last = std::find_if(
+      m_entries.begin(), m_entries.end(), [completed_frames](const Entry &e) {
+        return e.frame > completed_frames;
+      });
+  m_entries.erase(m_entries.begin(), last);
+}
+
+void DeletionQueue::flush() { m_entries.clear(); }
+
+} // namespace engine::core
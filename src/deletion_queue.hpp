@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>     // for size_t
+#include <memory>      // for unique_ptr, make_unique
+#include <type_traits> // for is_lvalue_reference_v
+#include <utility>     // for move
+#include <vector>      // for vector
+
+namespace engine::core {
+
+// Objects released while the GPU may still use them. Each one is tagged with
+// the frame it was released in and destroyed once that frame is known to be
+// complete, so nothing has to wait for the device to go idle. Anything
+// movable can be queued: buffers, VkDestroyable handles, meshes, swapchains.
+class DeletionQueue {
+private:
+  struct Retired {
+    Retired() = default;
+    Retired(const Retired &) = delete;
+    Retired(Retired &&) noexcept = delete;
+    Retired &operator=(const Retired &) = delete;
+    Retired &operator=(Retired &&) noexcept = delete;
+    virtual ~Retired() = default;
+  };
+
+  template <typename T> struct RetiredObject final : Retired {
+    T object;
+    explicit RetiredObject(T &&object) : object(std::move(object)) {}
+  };
+
+  struct Entry {
+    std::size_t frame = 0; // frames before it may use the object
+    std::unique_ptr<Retired> object;
+  };
+
+  // pushed in frame order, so completed entries are always at the front
+  std::vector<Entry> m_entries;
+
+public:
+  DeletionQueue() = default;
+
+  template <typename T>
+    requires(!std::is_lvalue_reference_v<T>)
+  void push(T &&object, std::size_t frame) {
+    m_entries.push_back(
+        {.frame = frame,
+         .object = std::make_unique<RetiredObject<T>>(std::move(object))});
+  }
+
+  // destroys, in release order, objects pushed with `frame` at most
+  // `completed_frames`; frames numbered below it must have finished
+  void collect(std::size_t completed_frames);
+
+  // destroys everything, the device must be idle
+  void flush();
+
+  [[nodiscard]] std::size_t size() const { return m_entries.size(); }
+
+  DeletionQueue(const DeletionQueue &) = delete;
+  DeletionQueue(DeletionQueue &&) noexcept = delete;
+  DeletionQueue &operator=(const DeletionQueue &) = delete;
+  DeletionQueue &operator=(DeletionQueue &&) noexcept = delete;
+
+  ~DeletionQueue() { flush(); }
+};
+
+} // namespace engine::core
@@ -0,0 +1,90 @@
+#include "draw_list.hpp"
+#include "cpu_profiler.hpp"     // for CpuScope
+#include "material.hpp"         // for Material
+#include "mesh.hpp"             // for Mesh
+#include <algorithm>            // for clamp, min
+#include <array>                // for array
+#include <bit>                  // for bit_cast
+#include <cstdio>               // for stderr
+#include <print>                // for println
+#include <vulkan/vulkan_core.h> // for VkBuffer
+
+namespace engine::core {
+
+std::uint32_t DrawList::IdTable::id(std::uint64_t value) {
+  const auto [it, inserted] = m_ids.try_emplace(
+      value, std::min(static_cast<std::uint32_t>(m_ids.size()), m_limit));
+  if (inserted && it->second == m_limit && !m_warned) {
+    m_warned = true;
+    std::println(stderr,
+                 "WARNING: more than {} distinct {}s in a frame, draws past "
+                 "it are not grouped by {}",
+                 m_limit, m_name, m_name);
+  }
+  return it->second;
+}
+
+void DrawList::clear() {
+  m_items.clear();
+  m_pipeline_ids.clear();
+  m_material_ids.clear();
+  m_buffer_ids.clear();
+}
+
+void DrawList::add(const resources::Mesh *mesh, unsigned pass, float depth,
+                   unsigned first_instance, unsigned instance_count) {
+  const resources::Material *material = mesh->material();
+  const auto quantized_depth = static_cast<std::uint64_t>(
+      std::clamp(depth, 0.0f, 1.0f) *
+      static_cast<float>((1u << DEPTH_BITS) - 1));
+
+  std::uint64_t key = std::min(pass, (1u << PASS_BITS) - 1);
+  key = key << PIPELINE_BITS | m_pipeline_ids.id(material->pipeline_key());
+  key = key << MATERIAL_BITS |
+        m_material_ids.id(std::bit_cast<std::uintptr_t>(material));
+  const VkBuffer vertex_buffer = mesh->vertices().buffer();
+  key = key << BUFFER_BITS |
+        m_buffer_ids.id(std::bit_cast<std::uint64_t>(vertex_buffer));
+  key = key << DEPTH_BITS | quantized_depth;
+  m_items.push_back({.key = key,
+                     .mesh = mesh,
+                     .first_instance = first_instance,
+                     .instance_count = instance_count});
+}
+
+void DrawList::sort() {
+  const CpuScope scope("sort draws");
+  if (m_items.size() < 2) {
+    return;
+  }
+
+  // bytes where every key agrees do not affect the order
+  std::uint64_t differing = 0;
+  for (const Item &item : m_items) {
+    differing |= item.key ^ m_items.front().key;
+  }
+
+  m_scratch.resize(m_items.size());
+  for (unsigned shift = 0; shift < 64; shift += 8) {
+    if (((differing >> shift) & 0xff) == 0) {
+      continue;
+    }
+
+    std::array<std::size_t, 256> offsets{};
+    for (const Item &item : m_items) {
+      ++offsets[(item.key >> shift) & 0xff];
+    }
+    std::size_t total = 0;
+    for (std::size_t &offset : offsets) {
+      const std::size_t count = offset;
+      offset = total;
+      total += count;
+    }
+    for (const Item &item : m_items) {
+      m_scratch[offsets[(item.key >> shift) & 0xff]++] = item;
+    }
+    m_items.swap(m_scratch);
+  }
+}
+
+} // namespace engine::core
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>       // for size_t
+#include <cstdint>       // for uint64_t, uint32_t
+#include <span>          // for span
+#include <unordered_map> // for unordered_map
+#include <vector>        // for vector
+
+namespace engine::resources {
+class Mesh;
+} // namespace engine::resources
+
+namespace engine::core {
+
+// Draws of a frame ordered by packed 64-bit keys, most significant first:
+//   pass (4) | pipeline (16) | material (16) | vertex buffer (12) | depth (16)
+// so that draws sharing state end up next to each other and the recorder can
+// skip rebinding it. Ids are handed out on first sight within a frame and the
+// tables start over on `clear`, so resources that are gone do not hold on to
+// theirs. Should a field still run out of ids in one frame, the rest share
+// its last value, which only costs grouping, never correctness.
+class DrawList {
+public:
+  struct Item {
+    std::uint64_t key = 0;
+    const resources::Mesh *mesh = nullptr;
+    // range in the frame's instance buffer, used by instanced materials
+    unsigned first_instance = 0;
+    unsigned instance_count = 1;
+  };
+
+  static constexpr unsigned PASS_BITS = 4;
+  static constexpr unsigned PIPELINE_BITS = 16;
+  static constexpr unsigned MATERIAL_BITS = 16;
+  static constexpr unsigned BUFFER_BITS = 12;
+  static constexpr unsigned DEPTH_BITS = 16;
+  static_assert(PASS_BITS + PIPELINE_BITS + MATERIAL_BITS + BUFFER_BITS +
+                    DEPTH_BITS ==
+                64);
+
+  void clear();
+
+  // `mesh` must have a ready material; `depth` in [0, 1] is clamped, smaller
+  // values are drawn first within otherwise equal state
+  void add(const resources::Mesh *mesh, unsigned pass = 0, float depth = 0.0f,
+           unsigned first_instance = 0, unsigned instance_count = 1);
+
+  // stable LSD radix sort over the key bytes, bytes equal in every key are
+  // skipped
+  void sort();
+
+  [[nodiscard]] std::span<const Item> items() const { return m_items; }
+  [[nodiscard]] std::size_t size() const { return m_items.size(); }
+
+private:
+  class IdTable {
+  private:
+    std::unordered_map<std::uint64_t, std::uint32_t> m_ids;
+    std::uint32_t m_limit = 0;
+    const char *m_name = nullptr;
+    bool m_warned = false; // saturation is reported once
+
+  public:
+    IdTable(unsigned bits, const char *name)
+        : m_limit((1u << bits) - 1), m_name(name) {}
+
+    [[nodiscard]] std::uint32_t id(std::uint64_t value);
+
+    void clear() { m_ids.clear(); }
+  };
+
+  std::vector<Item> m_items;
+  std::vector<Item> m_scratch;
+  IdTable m_pipeline_ids{PIPELINE_BITS, "pipeline"};
+  IdTable m_material_ids{MATERIAL_BITS, "material"};
+  IdTable m_buffer_ids{BUFFER_BITS, "buffer"};
+};
+
+} // namespace engine::core
@@ -51,6 +51,10 @@ struct SwapchainCreationError : EngineError {
   SwapchainCreationError() : EngineError("Failed to create swapchain!") {}
 };
 
+struct ImageCreationError : EngineError {
+  ImageCreationError() : EngineError("Failed to create image!") {}
+};
+
 struct ImageViewCreationError : EngineError {
   ImageViewCreationError() : EngineError("Failed to create image view!") {}
 };
@@ -78,6 +82,11 @@ struct RenderingPipelineCreationError : EngineError {
       : EngineError("Failed to create graphics pipeline!") {}
 };
 
+struct PipelineCacheCreationError : EngineError {
+  PipelineCacheCreationError()
+      : EngineError("Failed to create pipeline cache!") {}
+};
+
 struct CommandPoolCreationError : EngineError {
   CommandPoolCreationError() : EngineError("Failed to create command pool!") {}
 };
@@ -97,6 +106,11 @@ struct SyncPrimitivesCreationError : EngineError {
       : EngineError("Failed to create synchronization primitive(s)!") {}
 };
 
+struct SemaphoreWaitError : EngineError {
+  SemaphoreWaitError()
+      : EngineError("Failed to wait for timeline semaphore!") {}
+};
+
 struct SubmitCommandBufferError : EngineError {
   SubmitCommandBufferError()
       : EngineError("Failed to submit draw command buffer!") {}
@@ -120,4 +134,33 @@ struct MemoryAllocationError : EngineError {
       : EngineError("Failed to allocate memory for vertex buffer!") {}
 };
 
+struct StagingRingOverflowError : EngineError {
+  StagingRingOverflowError()
+      : EngineError("Upload does not fit into staging ring buffer!") {}
+};
+
+struct QueryPoolCreationError : EngineError {
+  QueryPoolCreationError() : EngineError("Failed to create query pool!") {}
+};
+
+struct DescriptorSetLayoutCreationError : EngineError {
+  DescriptorSetLayoutCreationError()
+      : EngineError("Failed to create descriptor set layout!") {}
+};
+
+struct DescriptorPoolCreationError : EngineError {
+  DescriptorPoolCreationError()
+      : EngineError("Failed to create descriptor pool!") {}
+};
+
+struct DescriptorSetAllocationError : EngineError {
+  DescriptorSetAllocationError()
+      : EngineError("Failed to allocate descriptor set(s)!") {}
+};
+
+struct ComputePipelineCreationError : EngineError {
+  ComputePipelineCreationError()
+      : EngineError("Failed to create compute pipeline!") {}
+};
+
 } // namespace engine::exceptions
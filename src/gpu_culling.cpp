@@ -0,0 +1,211 @@
+#include "gpu_culling.hpp"
+#include "compute_pipeline.hpp"   // for ComputePipelineMaker, ComputeRecorder
+#include "engine_exceptions.hpp"  // for DescriptorPoolCreationError, Descr...
+#include "glm/geometric.hpp"
+#include "rendering_pipeline.hpp" // for PipelineLayoutMaker
+#include "renderer.hpp"           // for Renderer
+#include <algorithm>              // for max
+#include <cstring>                // for memcpy
+
+namespace engine::core {
+
+namespace {
+
+constexpr std::array<VkDescriptorType, 6> BINDINGS = {
+    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, // instances
+    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, // records
+    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, // bounds
+    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, // commands
+    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, // visible
+    VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, // frustum
+};
+
+constexpr VkMemoryPropertyFlags HOST_VISIBLE =
+    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+void grow(Renderer &renderer, Buffer &buffer, VkDeviceSize size,
+          VkBufferUsageFlags usage, VkMemoryPropertyFlags properties) {
+  if (buffer.size() < size) {
+    buffer = Buffer(renderer, std::max(size, 2 * buffer.size()), usage);
+    buffer.allocate(properties);
+  }
+}
+
+} // namespace
+
+GpuCuller::GpuCuller(Renderer &renderer, std::size_t frames_in_flight)
+    : m_renderer(&renderer), m_device(renderer.device()),
+      m_frames(frames_in_flight) {
+  DescriptorSetLayoutMaker set_layout_maker(m_device);
+  for (unsigned i = 0; i < BINDINGS.size(); ++i) {
+    set_layout_maker.add_binding(i, BINDINGS[i], VK_SHADER_STAGE_COMPUTE_BIT);
+  }
+  m_set_layout = set_layout_maker.make_descriptor_set_layout();
+  const VkDescriptorSetLayout set_layout = m_set_layout;
+
+  m_layout = PipelineLayoutMaker(m_device)
+                 .add_descriptor_set_layout(set_layout,
+                                            set_layout_maker.bindings())
+                 .add_push_constant(VK_SHADER_STAGE_COMPUTE_BIT,
+                                    sizeof(unsigned))
+                 .make_pipeline_layout();
+
+  m_pipeline = ComputePipelineMaker(m_device, &renderer.shaders())
+                   .set_shader("cull.comp.glsl.spv")
+                   .set_specialization_constant(0, WORKGROUP_SIZE)
+                   .set_pipeline_layout(m_layout)
+                   .make_compute_pipeline(renderer.pipeline_cache().cache());
+
+  const auto frame_count = static_cast<unsigned>(frames_in_flight);
+  const std::array<VkDescriptorPoolSize, 2> pool_sizes = {
+      {{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 5 * frame_count},
+       {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, frame_count}}};
+  const VkDescriptorPoolCreateInfo pool_info{
+      .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = 0,
+      .maxSets = frame_count,
+      .poolSizeCount = static_cast<unsigned>(pool_sizes.size()),
+      .pPoolSizes = pool_sizes.data()};
+  VkDescriptorPool pool = VK_NULL_HANDLE;
+  if (vkCreateDescriptorPool(m_device, &pool_info, nullptr, &pool) !=
+      VK_SUCCESS) {
+    throw exceptions::DescriptorPoolCreationError{};
+  }
+  m_descriptor_pool = {pool, m_device};
+
+  const std::vector<VkDescriptorSetLayout> set_layouts(frames_in_flight,
+                                                       set_layout);
+  std::vector<VkDescriptorSet> sets(frames_in_flight);
+  const VkDescriptorSetAllocateInfo allocate_info{
+      .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+      .pNext = nullptr,
+      .descriptorPool = pool,
+      .descriptorSetCount = frame_count,
+      .pSetLayouts = set_layouts.data()};
+  if (vkAllocateDescriptorSets(m_device, &allocate_info, sets.data()) !=
+      VK_SUCCESS) {
+    throw exceptions::DescriptorSetAllocationError{};
+  }
+  for (std::size_t i = 0; i < frames_in_flight; ++i) {
+    m_frames[i].descriptor_set = sets[i];
+  }
+
+  set_view_projection(glm::mat4{1.0f});
+}
+
+void GpuCuller::set_view_projection(const glm::mat4 &view_projection) {
+  // planes from the rows of the matrix, clip space depth is [0, 1]
+  auto row = [&view_projection](int i) {
+    return glm::vec4(view_projection[0][i], view_projection[1][i],
+                     view_projection[2][i], view_projection[3][i]);
+  };
+  m_planes = {row(3) + row(0), row(3) - row(0), row(3) + row(1),
+              row(3) - row(1), row(2),          row(3) - row(2)};
+  for (glm::vec4 &plane : m_planes) {
+    plane /= glm::length(glm::vec3(plane));
+  }
+}
+
+void GpuCuller::begin_frame(std::size_t frame, VkBuffer instances,
+                            std::size_t instance_count, VkBuffer templates,
+                            std::span<const Draw> draws) {
+  m_frame = frame;
+  m_templates = templates;
+  m_command_count = draws.size();
+  m_record_count = 0;
+  for (const Draw &draw : draws) {
+    m_record_count += draw.instance_count;
+  }
+  Frame &current = m_frames[frame];
+
+  grow(*m_renderer, current.records,
+       std::max<std::size_t>(m_record_count, 1) * sizeof(Record),
+       VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, HOST_VISIBLE);
+  grow(*m_renderer, current.bounds,
+       std::max<std::size_t>(m_command_count, 1) * sizeof(glm::vec4),
+       VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, HOST_VISIBLE);
+  grow(*m_renderer, current.commands,
+       std::max<std::size_t>(m_command_count, 1) *
+           sizeof(VkDrawIndexedIndirectCommand),
+       VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+           VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+           VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+       VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+  grow(*m_renderer, current.visible,
+       std::max<std::size_t>(instance_count, 1) * sizeof(unsigned),
+       VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+  grow(*m_renderer, current.frustum, sizeof(m_planes),
+       VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, HOST_VISIBLE);
+  std::memcpy(current.frustum.mapped(), m_planes.data(), sizeof(m_planes));
+
+  auto *records = reinterpret_cast<Record *>(current.records.mapped());
+  auto *bounds = reinterpret_cast<glm::vec4 *>(current.bounds.mapped());
+  for (unsigned command = 0; command < draws.size(); ++command) {
+    const Draw &draw = draws[command];
+    bounds[command] = draw.bounding_sphere;
+    for (unsigned i = 0; i < draw.instance_count; ++i) {
+      *records++ = {.instance = draw.first_instance + i, .command = command};
+    }
+  }
+
+  // buffers may have been replaced, so the set is rewritten every frame; the
+  // slot's previous frame is done with it
+  const std::array<VkDescriptorBufferInfo, BINDINGS.size()> buffer_infos = {
+      {{instances, 0, VK_WHOLE_SIZE},
+       {current.records.buffer(), 0, VK_WHOLE_SIZE},
+       {current.bounds.buffer(), 0, VK_WHOLE_SIZE},
+       {current.commands.buffer(), 0, VK_WHOLE_SIZE},
+       {current.visible.buffer(), 0, VK_WHOLE_SIZE},
+       {current.frustum.buffer(), 0, VK_WHOLE_SIZE}}};
+  std::array<VkWriteDescriptorSet, BINDINGS.size()> writes{};
+  for (unsigned i = 0; i < writes.size(); ++i) {
+    writes[i] = {.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                 .pNext = nullptr,
+                 .dstSet = current.descriptor_set,
+                 .dstBinding = i,
+                 .dstArrayElement = 0,
+                 .descriptorCount = 1,
+                 .descriptorType = BINDINGS[i],
+                 .pImageInfo = nullptr,
+                 .pBufferInfo = &buffer_infos[i],
+                 .pTexelBufferView = nullptr};
+  }
+  vkUpdateDescriptorSets(m_device, static_cast<unsigned>(writes.size()),
+                         writes.data(), 0, nullptr);
+}
+
+void GpuCuller::record(VkCommandBuffer command_buffer) {
+  const Frame &current = m_frames[m_frame];
+  const VkBufferCopy reset{
+      .srcOffset = 0,
+      .dstOffset = 0,
+      .size = m_command_count * sizeof(VkDrawIndexedIndirectCommand)};
+  vkCmdCopyBuffer(command_buffer, m_templates, current.commands.buffer(), 1,
+                  &reset);
+
+  const VkBufferMemoryBarrier reset_barrier{
+      .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+      .pNext = nullptr,
+      .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+      .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+      .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .buffer = current.commands.buffer(),
+      .offset = 0,
+      .size = VK_WHOLE_SIZE};
+  vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 1,
+                       &reset_barrier, 0, nullptr);
+
+  const auto record_count = static_cast<unsigned>(m_record_count);
+  ComputeRecorder recorder(command_buffer);
+  recorder.bind(m_pipeline, m_layout, std::span(&current.descriptor_set, 1))
+      .push_constants(record_count)
+      .dispatch_invocations(record_count, WORKGROUP_SIZE)
+      .barrier({ComputeRecorder::Consumer::INDIRECT_DRAW,
+                ComputeRecorder::Consumer::VERTEX_SHADER},
+               {current.commands.buffer(), current.visible.buffer()});
+}
+
+} // namespace engine::core
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "glm/mat4x4.hpp"
+#include "glm/vec4.hpp"
+#include "vulkan_buffers.hpp"     // for Buffer
+#include "vulkan_destroyable.hpp" // for VkDestroyable, VkPipelineWrapper
+#include <array>                  // for array
+#include <cstddef>                // for size_t
+#include <span>                   // for span
+#include <vector>                 // for vector
+#include <vulkan/vulkan_core.h>   // for VkCommandBuffer, VkDescriptorSet
+
+namespace engine::core {
+
+class Renderer;
+
+// Frustum culling of instanced draws in a compute pass. Every draw list item
+// keeps its own indexed indirect command, which starts with no instances;
+// one dispatch over every instance counts the survivors into their command's
+// instanceCount and compacts their indices behind the command's
+// firstInstance in a per-frame visible-instance buffer, through which the
+// vertex shader fetches transforms. Outputs are per frame slot.
+class GpuCuller {
+public:
+  // one indirect command and the instances it may draw
+  struct Draw {
+    glm::vec4 bounding_sphere{0.0f}; // mesh space center and radius
+    unsigned first_instance = 0;     // in the frame's instance data
+    unsigned instance_count = 0;
+  };
+
+  // specialization constant 0 of cull.comp.glsl
+  static constexpr unsigned WORKGROUP_SIZE = 64;
+
+  GpuCuller(Renderer &renderer, std::size_t frames_in_flight);
+
+  // frustum of the view-projection the instanced draws are rendered with
+  void set_view_projection(const glm::mat4 &view_projection);
+
+  // uploads one record per instance of `draws` and points slot `frame`'s
+  // descriptors at `instances`, which holds `instance_count` InstanceData.
+  // `templates` holds draw `i`'s command at index `i` with no instances and
+  // `first_instance` as firstInstance; call after the slot's previous frame
+  // has completed
+  void begin_frame(std::size_t frame, VkBuffer instances,
+                   std::size_t instance_count, VkBuffer templates,
+                   std::span<const Draw> draws);
+
+  // resets the commands from their templates, culls in a single dispatch
+  // and makes the results visible to indirect draws and vertex shaders;
+  // outside of a render pass
+  void record(VkCommandBuffer command_buffer);
+
+  [[nodiscard]] VkBuffer commands() const {
+    return m_frames[m_frame].commands.buffer();
+  }
+  // per drawn instance, the index of its InstanceData
+  [[nodiscard]] VkBuffer visible() const {
+    return m_frames[m_frame].visible.buffer();
+  }
+
+  GpuCuller(const GpuCuller &) = delete;
+  GpuCuller(GpuCuller &&) noexcept = delete;
+  GpuCuller &operator=(const GpuCuller &) = delete;
+  GpuCuller &operator=(GpuCuller &&) noexcept = delete;
+  ~GpuCuller() = default;
+
+private:
+  // one per instance of a culled draw, `Record` of cull.comp.glsl
+  struct Record {
+    unsigned instance = 0;
+    unsigned command = 0;
+  };
+
+  struct Frame {
+    Buffer records;  // host visible
+    Buffer bounds;   // host visible, one sphere per command
+    Buffer commands; // device local
+    Buffer visible;  // device local, one index per instance
+    Buffer frustum;  // host visible planes
+    VkDescriptorSet descriptor_set = VK_NULL_HANDLE;
+  };
+
+  Renderer *m_renderer = nullptr;
+  VkDevice m_device = VK_NULL_HANDLE;
+  std::array<glm::vec4, 6> m_planes{};
+  VkDestroyable<VkDescriptorSetLayoutWrapper> m_set_layout;
+  VkDestroyable<VkPipelineLayoutWrapper> m_layout;
+  VkDestroyable<VkPipelineWrapper> m_pipeline;
+  VkDestroyable<VkDescriptorPoolWrapper> m_descriptor_pool;
+  std::vector<Frame> m_frames;
+  std::size_t m_frame = 0;
+  VkBuffer m_templates = VK_NULL_HANDLE;
+  std::size_t m_command_count = 0;
+  std::size_t m_record_count = 0;
+};
+
+} // namespace engine::core
@@ -0,0 +1,151 @@
+#include "gpu_profiler.hpp"
+#include "engine_exceptions.hpp" // for QueryPoolCreationError
+#include <algorithm>             // for min, min_element, max_element
+#include <cstddef>               // for ptrdiff_t
+#include <numeric>               // for accumulate
+
+namespace engine::core {
+
+GpuProfiler::GpuProfiler(VkDevice device, VkPhysicalDevice physical_device,
+                         unsigned queue_family_index,
+                         std::size_t frames_in_flight,
+                         std::uint32_t max_scopes_per_frame)
+    : m_device(device), m_max_queries(max_scopes_per_frame * 2),
+      m_frames(frames_in_flight) {
+  VkPhysicalDeviceProperties properties{};
+  vkGetPhysicalDeviceProperties(physical_device, &properties);
+  m_timestamp_period_ns = properties.limits.timestampPeriod;
+
+  unsigned family_count = 0;
+  vkGetPhysicalDeviceQueueFamilyProperties(physical_device, &family_count,
+                                           nullptr);
+  std::vector<VkQueueFamilyProperties> families(family_count);
+  vkGetPhysicalDeviceQueueFamilyProperties(physical_device, &family_count,
+                                           families.data());
+  const unsigned valid_bits =
+      queue_family_index < family_count
+          ? families[queue_family_index].timestampValidBits
+          : 0;
+  m_supported = valid_bits != 0 && m_timestamp_period_ns > 0.0;
+  if (!m_supported) {
+    return;
+  }
+  if (valid_bits < 64) {
+    m_timestamp_mask = (std::uint64_t{1} << valid_bits) - 1;
+  }
+
+  const VkQueryPoolCreateInfo create_info{
+      .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = 0,
+      .queryType = VK_QUERY_TYPE_TIMESTAMP,
+      .queryCount = m_max_queries,
+      .pipelineStatistics = 0};
+  for (Frame &frame : m_frames) {
+    VkQueryPool pool = VK_NULL_HANDLE;
+    if (vkCreateQueryPool(device, &create_info, nullptr, &pool) !=
+        VK_SUCCESS) {
+      throw exceptions::QueryPoolCreationError{};
+    }
+    frame.pool = {pool, device};
+  }
+  // value and availability for each query
+  m_results.resize(static_cast<std::size_t>(m_max_queries) * 2);
+}
+
+void GpuProfiler::begin_frame(VkCommandBuffer command_buffer,
+                              std::size_t frame_index) {
+  if (!m_supported) {
+    return;
+  }
+  m_current = &m_frames[frame_index];
+  collect(*m_current);
+  vkCmdResetQueryPool(command_buffer, m_current->pool, 0, m_max_queries);
+}
+
+std::size_t GpuProfiler::begin_scope(VkCommandBuffer command_buffer,
+                                     std::string_view name) {
+  if (m_current == nullptr || m_current->used_queries + 2 > m_max_queries) {
+    return NOT_MEASURED;
+  }
+  const RecordedScope scope{.name = scope_index(name),
+                            .begin_query = m_current->used_queries};
+  m_current->used_queries += 2;
+  vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                      m_current->pool, scope.begin_query);
+  m_current->scopes.push_back(scope);
+  return m_current->scopes.size() - 1;
+}
+
+void GpuProfiler::end_scope(VkCommandBuffer command_buffer,
+                            std::size_t scope) {
+  if (scope == NOT_MEASURED) {
+    return;
+  }
+  vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                      m_current->pool,
+                      m_current->scopes[scope].begin_query + 1);
+}
+
+void GpuProfiler::collect(Frame &frame) {
+  if (frame.used_queries != 0) {
+    // no WAIT flag: the frame has completed, so this never blocks,
+    // queries that somehow are not available are just skipped
+    const VkResult result = vkGetQueryPoolResults(
+        m_device, frame.pool, 0, frame.used_queries,
+        frame.used_queries * 2 * sizeof(std::uint64_t), m_results.data(),
+        2 * sizeof(std::uint64_t),
+        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+    if (result == VK_SUCCESS || result == VK_NOT_READY) {
+      for (const RecordedScope &scope : frame.scopes) {
+        const std::size_t begin = static_cast<std::size_t>(scope.begin_query);
+        if (m_results[begin * 2 + 1] == 0 || m_results[begin * 2 + 3] == 0) {
+          continue;
+        }
+        const std::uint64_t ticks =
+            (m_results[begin * 2 + 2] - m_results[begin * 2]) &
+            m_timestamp_mask;
+        History &history = m_scopes[scope.name];
+        history.samples[history.count % WINDOW_SIZE] =
+            static_cast<double>(ticks) * m_timestamp_period_ns * 1e-6;
+        ++history.count;
+      }
+    }
+  }
+  frame.scopes.clear();
+  frame.used_queries = 0;
+}
+
+std::size_t GpuProfiler::scope_index(std::string_view name) {
+  if (auto it = m_scope_names.find(name); it != m_scope_names.end()) {
+    return it->second;
+  }
+  m_scopes.push_back({.name = std::string(name), .samples = {}, .count = 0});
+  m_scope_names.emplace(std::string(name), m_scopes.size() - 1);
+  return m_scopes.size() - 1;
+}
+
+std::vector<GpuProfiler::ScopeStats> GpuProfiler::stats() const {
+  std::vector<ScopeStats> result;
+  result.reserve(m_scope_names.size());
+  for (const auto &[name, index] : m_scope_names) {
+    const History &history = m_scopes[index];
+    const std::size_t samples = std::min(history.count, WINDOW_SIZE);
+    if (samples == 0) {
+      continue;
+    }
+    const auto window = history.samples.begin() +
+                        static_cast<std::ptrdiff_t>(samples);
+    result.push_back(
+        {.name = name,
+         .last_ms = history.samples[(history.count - 1) % WINDOW_SIZE],
+         .min_ms = *std::min_element(history.samples.begin(), window),
+         .avg_ms = std::accumulate(history.samples.begin(), window, 0.0) /
+                   static_cast<double>(samples),
+         .max_ms = *std::max_element(history.samples.begin(), window),
+         .samples = samples});
+  }
+  return result;
+}
+
+} // namespace engine::core
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "vulkan_destroyable.hpp" // for VkDestroyable, VkQueryPoolWrapper
+#include <array>                  // for array
+#include <cstddef>                // for size_t
+#include <cstdint>                // for uint32_t, uint64_t
+#include <functional>             // for less
+#include <map>                    // for map
+#include <string>                 // for string
+#include <string_view>            // for string_view
+#include <vector>                 // for vector
+#include <vulkan/vulkan_core.h>   // for VkCommandBuffer, VkQueryPool
+
+namespace engine::core {
+
+// Named GPU timings measured with timestamp queries. Every frame in flight
+// has its own query pool, results of a slot are read when the slot comes
+// around again, once its previous frame completed, so reading never stalls.
+// Recording is not thread-safe, scopes belong to the render thread.
+class GpuProfiler {
+public:
+  struct ScopeStats {
+    std::string name;
+    double last_ms = 0.0;
+    double min_ms = 0.0;
+    double avg_ms = 0.0;
+    double max_ms = 0.0;
+    std::size_t samples = 0; // within the rolling window
+  };
+
+  // closes the scope on destruction
+  class Scope {
+  private:
+    GpuProfiler *m_profiler = nullptr;
+    VkCommandBuffer m_command_buffer = VK_NULL_HANDLE;
+    std::size_t m_index = 0;
+
+  public:
+    Scope(GpuProfiler &profiler, VkCommandBuffer command_buffer,
+          std::string_view name)
+        : m_profiler(&profiler), m_command_buffer(command_buffer),
+          m_index(profiler.begin_scope(command_buffer, name)) {}
+
+    Scope(const Scope &) = delete;
+    Scope(Scope &&) noexcept = delete;
+    Scope &operator=(const Scope &) = delete;
+    Scope &operator=(Scope &&) noexcept = delete;
+
+    ~Scope() { m_profiler->end_scope(m_command_buffer, m_index); }
+  };
+
+  static constexpr std::size_t WINDOW_SIZE = 120;
+  // returned by `begin_scope` for scopes which are not measured
+  static constexpr std::size_t NOT_MEASURED = ~std::size_t{0};
+
+  GpuProfiler(VkDevice device, VkPhysicalDevice physical_device,
+              unsigned queue_family_index, std::size_t frames_in_flight,
+              std::uint32_t max_scopes_per_frame = 256);
+
+  // collects results of the frame previously recorded into `frame_index` and
+  // resets its queries; call once that frame has completed, before any
+  // scope and outside of a render pass
+  void begin_frame(VkCommandBuffer command_buffer, std::size_t frame_index);
+
+  // scopes past the per-frame budget or without timestamp support are
+  // silently not measured; returns a value to pass to `end_scope`
+  std::size_t begin_scope(VkCommandBuffer command_buffer,
+                          std::string_view name);
+  void end_scope(VkCommandBuffer command_buffer, std::size_t scope);
+
+  [[nodiscard]] bool supported() const { return m_supported; }
+
+  // per-draw scopes are costly to record, callers check this before opening
+  [[nodiscard]] bool per_draw_scopes() const { return m_per_draw_scopes; }
+  void set_per_draw_scopes(bool enabled) { m_per_draw_scopes = enabled; }
+
+  // ordered by name
+  [[nodiscard]] std::vector<ScopeStats> stats() const;
+
+  GpuProfiler(const GpuProfiler &) = delete;
+  GpuProfiler(GpuProfiler &&) noexcept = delete;
+  GpuProfiler &operator=(const GpuProfiler &) = delete;
+  GpuProfiler &operator=(GpuProfiler &&) noexcept = delete;
+  ~GpuProfiler() = default;
+
+private:
+  struct RecordedScope {
+    std::size_t name = 0; // index into m_scopes
+    std::uint32_t begin_query = 0;
+  };
+
+  struct Frame {
+    VkDestroyable<VkQueryPoolWrapper> pool;
+    std::vector<RecordedScope> scopes;
+    std::uint32_t used_queries = 0;
+  };
+
+  struct History {
+    std::string name;
+    std::array<double, WINDOW_SIZE> samples{};
+    std::size_t count = 0; // total samples ever added
+  };
+
+  VkDevice m_device = VK_NULL_HANDLE;
+  bool m_supported = false;
+  bool m_per_draw_scopes = false;
+  double m_timestamp_period_ns = 1.0;
+  std::uint64_t m_timestamp_mask = ~std::uint64_t{0};
+  std::uint32_t m_max_queries = 0;
+
+  std::vector<Frame> m_frames;
+  Frame *m_current = nullptr;
+  std::vector<std::uint64_t> m_results; // readback scratch
+
+  std::vector<History> m_scopes;
+  std::map<std::string, std::size_t, std::less<>> m_scope_names;
+
+  std::size_t scope_index(std::string_view name);
+  void collect(Frame &frame);
+};
+
+} // namespace engine::core
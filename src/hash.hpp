@@ -0,0 +1,79 @@
+#pragma once
+
+#include <concepts>    // for integral
+#include <cstddef>     // for byte, size_t
+#include <cstdint>     // for uint64_t
+#include <span>        // for span
+#include <type_traits> // for is_enum_v, is_floating_point_v
+#include <vector>      // for vector
+
+namespace engine::core {
+
+// FNV-1a. Only scalars are fed into it on purpose: vulkan create infos have
+// padding which is not guaranteed to be zeroed, so hashing them as raw bytes
+// would make identical states hash differently.
+class Hasher {
+private:
+  static constexpr std::uint64_t OFFSET_BASIS = 0xcbf29ce484222325ull;
+  static constexpr std::uint64_t PRIME = 0x100000001b3ull;
+
+  std::uint64_t m_state = OFFSET_BASIS;
+
+public:
+  Hasher &add(std::span<const std::byte> bytes) {
+    for (const std::byte b : bytes) {
+      m_state ^= static_cast<std::uint64_t>(b);
+      m_state *= PRIME;
+    }
+    return *this;
+  }
+
+  template <typename T>
+    requires std::integral<T> || std::is_enum_v<T> ||
+             std::is_floating_point_v<T>
+  Hasher &add(T value) {
+    return add(std::as_bytes(std::span(&value, 1)));
+  }
+
+  [[nodiscard]] std::uint64_t value() const { return m_state; }
+};
+
+// Canonical byte description of a creation state, fed the same scalars as a
+// `Hasher`. Maps keyed on it compare the whole state on lookup and use the
+// hash only for bucketing, so a collision can not alias two states.
+class StateKey {
+private:
+  std::vector<std::byte> m_bytes;
+
+public:
+  StateKey &add(std::span<const std::byte> bytes) {
+    m_bytes.insert(m_bytes.end(), bytes.begin(), bytes.end());
+    return *this;
+  }
+
+  template <typename T>
+    requires std::integral<T> || std::is_enum_v<T> ||
+             std::is_floating_point_v<T>
+  StateKey &add(T value) {
+    return add(std::as_bytes(std::span(&value, 1)));
+  }
+
+  // length prefixed, so different splits of a state never concatenate equal
+  StateKey &add(const StateKey &part) {
+    return add(part.m_bytes.size()).add(part.m_bytes);
+  }
+
+  [[nodiscard]] std::uint64_t hash() const {
+    return Hasher{}.add(m_bytes).value();
+  }
+
+  bool operator==(const StateKey &) const = default;
+};
+
+struct StateKeyHash {
+  std::size_t operator()(const StateKey &key) const {
+    return static_cast<std::size_t>(key.hash());
+  }
+};
+
+} // namespace engine::core
@@ -0,0 +1,207 @@
+#include "job_system.hpp"
+#include <utility> // for move, exchange
+
+namespace engine::core {
+
+namespace {
+
+// which worker of which system the current thread is
+thread_local const JobSystem *current_system = nullptr;
+thread_local std::size_t current_queue = 0;
+
+} // namespace
+
+std::size_t JobSystem::default_thread_count() {
+  // the thread waiting on the jobs takes part in them
+  return std::max(std::thread::hardware_concurrency(), 2u) - 1;
+}
+
+JobSystem::JobSystem(std::size_t threads) {
+  threads = threads == 0 ? 1 : threads;
+  m_queues.reserve(threads);
+  for (std::size_t i = 0; i < threads; ++i) {
+    m_queues.push_back(std::make_unique<Queue>());
+  }
+  m_workers.reserve(threads);
+  for (std::size_t i = 0; i < threads; ++i) {
+    m_workers.emplace_back([this, i] { work(i); });
+  }
+}
+
+JobSystem::~JobSystem() {
+  {
+    const std::lock_guard lock(m_sleep_mutex);
+    m_stop = true;
+  }
+  m_wake.notify_all();
+  m_workers.clear();
+}
+
+void JobSystem::submit(Job job, Counter *counter) {
+  if (counter != nullptr) {
+    const std::lock_guard lock(counter->m_mutex);
+    ++counter->m_pending;
+  }
+  push({.job = std::move(job), .counter = counter});
+}
+
+void JobSystem::submit_after(Counter &dependency, Job job, Counter *counter) {
+  if (counter != nullptr) {
+    const std::lock_guard lock(counter->m_mutex);
+    ++counter->m_pending;
+  }
+  {
+    const std::lock_guard lock(dependency.m_mutex);
+    if (dependency.m_pending != 0) {
+      dependency.m_continuations.emplace_back(std::move(job), counter);
+      return;
+    }
+  }
+  push({.job = std::move(job), .counter = counter});
+}
+
+void JobSystem::wait(Counter &counter) {
+  while (!counter.done()) {
+    if (run_one()) {
+      continue;
+    }
+    // nothing left to steal, sleep until the counter drops to zero or new
+    // jobs show up
+    std::unique_lock lock(m_sleep_mutex);
+    m_wake.wait(lock, [this, &counter] {
+      return counter.done() || m_queued.load(std::memory_order_acquire) != 0;
+    });
+  }
+  const std::lock_guard lock(counter.m_mutex);
+  if (counter.m_error) {
+    std::rethrow_exception(std::exchange(counter.m_error, nullptr));
+  }
+}
+
+void JobSystem::poll_errors() {
+  std::exception_ptr error;
+  {
+    const std::lock_guard lock(m_error_mutex);
+    error = std::exchange(m_detached_error, nullptr);
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+void JobSystem::push(Task task) {
+  const std::size_t index =
+      current_system == this
+          ? current_queue
+          : m_next_queue.fetch_add(1, std::memory_order_relaxed) %
+                m_queues.size();
+  // counted before it becomes visible, so the count never goes below zero
+  m_queued.fetch_add(1, std::memory_order_release);
+  {
+    const std::lock_guard lock(m_queues[index]->mutex);
+    m_queues[index]->tasks.push_back(std::move(task));
+  }
+  // taking the lock orders the wake-up after a worker's predicate check
+  {
+    const std::lock_guard lock(m_sleep_mutex);
+  }
+  m_wake.notify_one();
+}
+
+bool JobSystem::try_pop(Task &task) {
+  const std::size_t count = m_queues.size();
+  const bool worker = current_system == this;
+  if (worker) {
+    Queue &own = *m_queues[current_queue];
+    const std::lock_guard lock(own.mutex);
+    if (!own.tasks.empty()) {
+      task = std::move(own.tasks.back());
+      own.tasks.pop_back();
+      m_queued.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+
+  const std::size_t start =
+      worker ? current_queue + 1
+             : m_next_queue.load(std::memory_order_relaxed);
+  for (std::size_t i = 0; i < count; ++i) {
+    Queue &victim = *m_queues[(start + i) % count];
+    const std::lock_guard lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      m_queued.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool JobSystem::run_one() {
+  Task task;
+  if (!try_pop(task)) {
+    return false;
+  }
+  std::exception_ptr error;
+  try {
+    task.job();
+  } catch (...) {
+    error = std::current_exception();
+  }
+  if (error && task.counter == nullptr) {
+    // whoever happened to run the job is not the one to report it to
+    const std::lock_guard lock(m_error_mutex);
+    if (!m_detached_error) {
+      m_detached_error = std::move(error);
+    }
+    return true;
+  }
+  finish(task.counter, error);
+  return true;
+}
+
+void JobSystem::finish(Counter *counter, std::exception_ptr error) {
+  if (counter == nullptr) {
+    return;
+  }
+  std::vector<std::pair<Job, Counter *>> continuations;
+  {
+    const std::lock_guard lock(counter->m_mutex);
+    if (error && !counter->m_error) {
+      counter->m_error = std::move(error);
+    }
+    if (--counter->m_pending != 0) {
+      return;
+    }
+    continuations.swap(counter->m_continuations);
+  }
+  // `counter` may be gone by now, only its continuations are left
+  for (auto &[job, next] : continuations) {
+    push({.job = std::move(job), .counter = next});
+  }
+  // wakes whoever waits on it, the lock orders this after their check
+  {
+    const std::lock_guard lock(m_sleep_mutex);
+  }
+  m_wake.notify_all();
+}
+
+void JobSystem::work(std::size_t index) {
+  current_system = this;
+  current_queue = index;
+  while (true) {
+    if (run_one()) {
+      continue;
+    }
+    std::unique_lock lock(m_sleep_mutex);
+    m_wake.wait(lock, [this] {
+      return m_stop || m_queued.load(std::memory_order_acquire) != 0;
+    });
+    if (m_stop && m_queued.load(std::memory_order_acquire) == 0) {
+      return;
+    }
+  }
+}
+
+} // namespace engine::core
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <algorithm>          // for max, min
+#include <atomic>             // for atomic
+#include <condition_variable> // for condition_variable
+#include <cstddef>            // for size_t
+#include <deque>              // for deque
+#include <exception>          // for exception_ptr
+#include <functional>         // for function
+#include <memory>             // for unique_ptr
+#include <mutex>              // for mutex
+#include <thread>             // for jthread, hardware_concurrency
+#include <utility>            // for pair
+#include <vector>             // for vector
+
+namespace engine::core {
+
+// Work-stealing scheduler for short CPU jobs. Every worker owns a deque, it
+// takes its own jobs from the back while idle workers steal from the front of
+// the others'. Jobs are continuation style, there are no fibers: dependent
+// work either waits on a Counter, running queued jobs meanwhile, or is
+// scheduled with `submit_after`.
+class JobSystem {
+public:
+  using Job = std::function<void()>;
+
+  // Jobs submitted with it that have not finished yet. Continuations
+  // registered with `submit_after` are queued once it drops to zero; `wait`
+  // rethrows the first exception one of its jobs threw.
+  class Counter {
+  private:
+    friend class JobSystem;
+
+    mutable std::mutex m_mutex;
+    std::size_t m_pending = 0;
+    std::vector<std::pair<Job, Counter *>> m_continuations;
+    std::exception_ptr m_error;
+
+  public:
+    Counter() = default;
+
+    // locks, so a counter seen done is no longer touched by any worker and
+    // may be destroyed right away
+    [[nodiscard]] bool done() const {
+      const std::lock_guard lock(m_mutex);
+      return m_pending == 0;
+    }
+
+    Counter(const Counter &) = delete;
+    Counter(Counter &&) noexcept = delete;
+    Counter &operator=(const Counter &) = delete;
+    Counter &operator=(Counter &&) noexcept = delete;
+    ~Counter() = default;
+  };
+
+  // one worker less than there are hardware threads
+  [[nodiscard]] static std::size_t default_thread_count();
+
+  explicit JobSystem(std::size_t threads = default_thread_count());
+
+  // what a job without a counter throws is kept for `poll_errors`. Called
+  // from a worker, the job goes to that worker's own deque
+  void submit(Job job, Counter *counter = nullptr);
+
+  // queues `job` once every job counted by `dependency` has finished
+  void submit_after(Counter &dependency, Job job, Counter *counter = nullptr);
+
+  // runs queued jobs until `counter` is done, so jobs may wait as well;
+  // sleeps while there is nothing to run
+  void wait(Counter &counter);
+
+  // calls `body(begin, end)` on chunks of at most `grain` indices covering
+  // [0, count); the calling thread takes part
+  template <typename F>
+  void parallel_for(std::size_t count, std::size_t grain, const F &body) {
+    grain = std::max<std::size_t>(grain, 1);
+    Counter counter;
+    for (std::size_t begin = 0; begin < count; begin += grain) {
+      const std::size_t end = std::min(count, begin + grain);
+      submit([&body, begin, end] { body(begin, end); }, &counter);
+    }
+    wait(counter);
+  }
+
+  // rethrows, once, the first exception thrown by a job without a counter
+  // since the last call; such errors never surface from `wait`
+  void poll_errors();
+
+  [[nodiscard]] std::size_t size() const { return m_workers.size(); }
+
+  JobSystem(const JobSystem &) = delete;
+  JobSystem(JobSystem &&) noexcept = delete;
+  JobSystem &operator=(const JobSystem &) = delete;
+  JobSystem &operator=(JobSystem &&) noexcept = delete;
+
+  // finishes queued jobs before joining the workers
+  ~JobSystem();
+
+private:
+  struct Task {
+    Job job;
+    Counter *counter = nullptr;
+  };
+
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  std::vector<std::unique_ptr<Queue>> m_queues; // one per worker
+  std::atomic<std::size_t> m_queued = 0;
+  std::atomic<std::size_t> m_next_queue = 0; // for jobs from other threads
+
+  std::mutex m_error_mutex;
+  std::exception_ptr m_detached_error; // first one of a counter-less job
+
+  std::mutex m_sleep_mutex;
+  std::condition_variable m_wake;
+  bool m_stop = false;
+
+  // declared last: workers are joined before the queues go away
+  std::vector<std::jthread> m_workers;
+
+  void push(Task task);
+
+  // own deque first, then steals
+  bool try_pop(Task &task);
+
+  bool run_one();
+
+  void finish(Counter *counter, std::exception_ptr error);
+
+  void work(std::size_t index);
+};
+
+} // namespace engine::core
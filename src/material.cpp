@@ -1,11 +1,17 @@
 #include "material.hpp"
+#include "cpu_profiler.hpp"       // for CpuScope
 #include "renderer.hpp"           // for Renderer
 #include "rendering_pipeline.hpp" // for RenderingPipelineMaker, PipelineLa...
 #include "shader.hpp"             // for Shader
-#include "swapchain.hpp"          // for Swapchain
+#include "shader_cache.hpp"       // for ShaderCache
 #include "vertex.hpp"             // for Vertex
-#include <array>                  // for array
+#include <chrono>                 // for seconds
+#include <cstdio>                 // for stderr
+#include <exception>              // for exception
+#include <future>                 // for future_status
+#include <print>                  // for println
 #include <span>                   // for span
+#include <utility>                // for move
 #include <vulkan/vulkan_core.h>   // for VkCullModeFlagBits, VkFormat, VkFr...
 
 namespace engine::resources {
@@ -14,33 +20,71 @@ Material::Material(
     core::Renderer &renderer,
     const std::map<core::Shader::Stage, std::filesystem::path> &shaders,
     void *push_constant_data, std::size_t push_constant_size,
-    VkShaderStageFlags push_constant_stages)
+    VkShaderStageFlags push_constant_stages, bool instanced)
     : m_push_constant_data(push_constant_data),
       m_push_constant_size(push_constant_size),
-      m_push_constant_stages(push_constant_stages) {
+      m_push_constant_stages(push_constant_stages), m_instanced(instanced) {
+  const core::CpuScope scope("create material");
   core::PipelineLayoutMaker layout_maker(renderer.device());
+  if (instanced) {
+    layout_maker.add_descriptor_set_layout(renderer.instance_set_layout(),
+                                           renderer.instance_set_bindings());
+  }
   if (push_constant_data) {
     layout_maker.add_push_constant(push_constant_stages, push_constant_size);
   }
-  m_pipeline_layout = layout_maker.make_pipeline_layout();
 
-  core::RenderingPipelineMaker pipeline_maker(renderer.device());
-  m_pipeline =
-      pipeline_maker.set_pipeline_layout(m_pipeline_layout)
-          .set_shaders(shaders)
-          .set_input_topology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
-          .set_polygon_mode(VK_POLYGON_MODE_FILL)
-          .set_cull_mode(VK_CULL_MODE_NONE, VK_FRONT_FACE_CLOCKWISE)
-          .set_no_multisampling()
-          .disable_blending()
-          .disable_depthtest()
-          .set_color_attachment_format(renderer.swapchain().image_format())
-          .set_depth_format(VK_FORMAT_UNDEFINED)
-          .set_vertex_description(
-              resources::Vertex::binding_description(),
-              std::span(resources::Vertex::attribute_description().data(),
-                        resources::Vertex::attribute_description().size()))
-          .make_rendering_pipeline(renderer.render_pass());
+  core::RenderingPipelineMaker pipeline_maker(renderer.device(),
+                                              &renderer.shaders());
+  pipeline_maker.set_shaders(shaders)
+      .set_input_topology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
+      .set_polygon_mode(VK_POLYGON_MODE_FILL)
+      .set_cull_mode(VK_CULL_MODE_NONE, VK_FRONT_FACE_CLOCKWISE)
+      .set_no_multisampling()
+      .disable_blending()
+      .disable_depthtest()
+      .set_color_attachment_format(renderer.color_format())
+      .set_depth_format(VK_FORMAT_UNDEFINED)
+      .set_vertex_description(
+          resources::Vertex::binding_description(),
+          std::span(resources::Vertex::attribute_description().data(),
+                    resources::Vertex::attribute_description().size()));
+
+  m_pending_pipeline = renderer.pipelines().acquire_async(
+      layout_maker, std::move(pipeline_maker), renderer.render_pass());
+}
+
+bool Material::ready() const {
+  if (!m_pipeline && m_pending_pipeline.valid() &&
+      m_pending_pipeline.wait_for(std::chrono::seconds(0)) ==
+          std::future_status::ready) {
+    // called while a frame is recorded, which must not be left half done
+    try {
+      m_pipeline = m_pending_pipeline.get();
+    } catch (const std::exception &error) {
+      m_failed = true;
+      std::println(stderr, "WARNING: material pipeline build failed: {}",
+                   error.what());
+    } catch (...) {
+      m_failed = true;
+      std::println(stderr, "WARNING: material pipeline build failed");
+    }
+    m_pending_pipeline = {};
+  }
+  return m_pipeline != nullptr;
+}
+
+void Material::wait() const {
+  if (!m_pipeline && m_pending_pipeline.valid()) {
+    const core::PipelineFuture pending = std::move(m_pending_pipeline);
+    m_pending_pipeline = {};
+    try {
+      m_pipeline = pending.get();
+    } catch (...) {
+      m_failed = true;
+      throw;
+    }
+  }
 }
 
 } // namespace engine::resources
@@ -1,37 +1,65 @@
 #pragma once
 
+#include "pipeline_registry.hpp"  // for SharedPipeline
 #include "renderer.hpp"           // for Renderer
 #include "shader.hpp"             // for Shader
-#include "vulkan_destroyable.hpp" // for VkDestroyable, VkPipelineLayoutWra...
 #include <cstddef>                // for size_t
+#include <cstdint>                // for uint64_t
 #include <filesystem>             // for path
 #include <map>                    // for map
 #include <vulkan/vulkan_core.h>   // for VkShaderStageFlags, vkCmdPushConst...
 
 namespace engine::resources {
 
+// Pipeline is compiled on the renderer's worker pool; until it is ready the
+// material's draws are skipped, as they are for good if the build failed.
 class Material {
 private:
-  core::VkDestroyable<core::VkPipelineLayoutWrapper> m_pipeline_layout;
-  core::VkDestroyable<core::VkPipelineWrapper> m_pipeline;
+  mutable core::SharedPipeline m_pipeline;
+  mutable core::PipelineFuture m_pending_pipeline;
   void *m_push_constant_data = nullptr;
   std::size_t m_push_constant_size = 0;
   VkShaderStageFlags m_push_constant_stages = 0;
+  bool m_instanced = false;
+  mutable bool m_failed = false;
 
 public:
   Material() = default;
 
+  // instanced materials take the renderer's instance set as set 0, see
+  // Renderer::instance_set_layout, and can only be drawn through
+  // Renderer::submit_instanced
   Material(core::Renderer &renderer,
            const std::map<core::Shader::Stage, std::filesystem::path> &shaders,
            void *push_constant_data = nullptr,
            std::size_t push_constant_size = 0,
-           VkShaderStageFlags push_constant_stages = 0);
+           VkShaderStageFlags push_constant_stages = 0,
+           bool instanced = false);
+
+  // polls the asynchronous build, never blocks or throws; a failed build
+  // is logged once and the material never becomes ready
+  [[nodiscard]] bool ready() const;
+  [[nodiscard]] bool failed() const { return m_failed; }
+
+  // blocks until the pipeline is built, rethrows a failed build
+  void wait() const;
+
+  [[nodiscard]] VkPipeline pipeline() const {
+    return m_pipeline ? m_pipeline->pipeline.get_underlying() : VK_NULL_HANDLE;
+  }
+  [[nodiscard]] VkPipelineLayout pipeline_layout() const {
+    return m_pipeline ? m_pipeline->layout.get_underlying() : VK_NULL_HANDLE;
+  }
+  [[nodiscard]] bool instanced() const { return m_instanced; }
+  // materials with equal keys share the very same pipeline
+  [[nodiscard]] std::uint64_t pipeline_key() const {
+    return m_pipeline ? m_pipeline->key : 0;
+  }
 
-  [[nodiscard]] VkPipeline pipeline() const { return m_pipeline; }
   void update_push_constants(VkCommandBuffer command_buffer) const {
     if (m_push_constant_data) {
       vkCmdPushConstants(
-          command_buffer, m_pipeline_layout, m_push_constant_stages, 0,
+          command_buffer, m_pipeline->layout, m_push_constant_stages, 0,
           static_cast<unsigned>(m_push_constant_size), m_push_constant_data);
     }
   }
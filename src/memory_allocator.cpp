@@ -0,0 +1,236 @@
+#include "memory_allocator.hpp"
+#include "engine_exceptions.hpp"       // for MemoryAllocationError
+#include "physical_device_queries.hpp" // for find_memory_type
+#include <algorithm>                   // for min, max, find_if
+#include <iterator>                    // for next, prev
+
+namespace engine::core {
+
+namespace {
+
+VkDeviceSize align_up(VkDeviceSize value, VkDeviceSize alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+std::optional<FreeList::Range> FreeList::allocate(VkDeviceSize size,
+                                                  VkDeviceSize alignment) {
+  alignment = std::max<VkDeviceSize>(alignment, 1);
+  for (auto it = m_ranges.begin(); it != m_ranges.end(); ++it) {
+    const auto [range_offset, range_size] = *it;
+    const VkDeviceSize aligned = align_up(range_offset, alignment);
+    const VkDeviceSize padding = aligned - range_offset;
+    if (padding + size > range_size) {
+      continue;
+    }
+
+    m_ranges.erase(it);
+    const VkDeviceSize taken = padding + size;
+    if (taken < range_size) {
+      m_ranges.emplace(range_offset + taken, range_size - taken);
+    }
+    return Range{.offset = aligned,
+                 .range_offset = range_offset,
+                 .range_size = taken};
+  }
+  return std::nullopt;
+}
+
+void FreeList::release(VkDeviceSize range_offset, VkDeviceSize range_size) {
+  VkDeviceSize offset = range_offset;
+  VkDeviceSize size = range_size;
+  // coalesce with the right neighbour
+  auto next = m_ranges.lower_bound(offset);
+  if (next != m_ranges.end() && offset + size == next->first) {
+    size += next->second;
+    next = m_ranges.erase(next);
+  }
+  // coalesce with the left neighbour
+  if (next != m_ranges.begin()) {
+    auto prev = std::prev(next);
+    if (prev->first + prev->second == offset) {
+      offset = prev->first;
+      size += prev->second;
+      m_ranges.erase(prev);
+    }
+  }
+  m_ranges.emplace(offset, size);
+}
+
+VkDeviceSize FreeList::free_bytes() const {
+  VkDeviceSize bytes = 0;
+  for (const auto &[offset, size] : m_ranges) {
+    bytes += size;
+  }
+  return bytes;
+}
+
+VkDeviceSize FreeList::largest_free() const {
+  VkDeviceSize largest = 0;
+  for (const auto &[offset, size] : m_ranges) {
+    largest = std::max(largest, size);
+  }
+  return largest;
+}
+
+MemoryAllocation &
+MemoryAllocation::operator=(MemoryAllocation &&other) noexcept {
+  if (this != &other) {
+    std::swap(m_allocator, other.m_allocator);
+    std::swap(m_block, other.m_block);
+    std::swap(m_memory, other.m_memory);
+    std::swap(m_offset, other.m_offset);
+    std::swap(m_size, other.m_size);
+    std::swap(m_range_offset, other.m_range_offset);
+    std::swap(m_range_size, other.m_range_size);
+    std::swap(m_mapped, other.m_mapped);
+  }
+  return *this;
+}
+
+MemoryAllocation::~MemoryAllocation() {
+  if (m_allocator != nullptr && m_block != nullptr) {
+    m_allocator->free(*this);
+  }
+}
+
+MemoryAllocator::MemoryAllocator(VkDevice device,
+                                 VkPhysicalDevice physical_device,
+                                 VkDeviceSize block_size)
+    : m_device(device), m_block_size(block_size) {
+  vkGetPhysicalDeviceMemoryProperties(physical_device, &m_memory_properties);
+}
+
+MemoryAllocator::Block &MemoryAllocator::make_block(unsigned memory_type,
+                                                    VkDeviceSize size) {
+  const VkMemoryAllocateInfo alloc_info{
+      .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+      .pNext = nullptr,
+      .allocationSize = size,
+      .memoryTypeIndex = memory_type,
+  };
+
+  VkDeviceMemory memory = VK_NULL_HANDLE;
+  if (vkAllocateMemory(m_device, &alloc_info, nullptr, &memory) !=
+      VK_SUCCESS) {
+    throw exceptions::MemoryAllocationError{};
+  }
+
+  auto block = std::make_unique<Block>();
+  block->memory = {memory, m_device};
+  block->size = size;
+  block->memory_type = memory_type;
+  block->free_list = FreeList(size);
+
+  // only one mapping per `VkDeviceMemory` is allowed, so host visible blocks
+  // are mapped once for their whole lifetime
+  if (m_memory_properties.memoryTypes[memory_type].propertyFlags &
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+    void *mapped = nullptr;
+    if (vkMapMemory(m_device, memory, 0, VK_WHOLE_SIZE, 0, &mapped) !=
+        VK_SUCCESS) {
+      throw exceptions::MemoryAllocationError{};
+    }
+    block->mapped = static_cast<std::byte *>(mapped);
+  }
+
+  return *m_blocks[memory_type].emplace_back(std::move(block));
+}
+
+bool MemoryAllocator::try_allocate(Block &block,
+                                   const VkMemoryRequirements &reqs,
+                                   MemoryAllocation &allocation) {
+  const auto range = block.free_list.allocate(reqs.size, reqs.alignment);
+  if (!range) {
+    return false;
+  }
+  ++block.allocation_count;
+  block.wasted_bytes += range->offset - range->range_offset;
+
+  allocation.m_allocator = this;
+  allocation.m_block = &block;
+  allocation.m_memory = block.memory;
+  allocation.m_offset = range->offset;
+  allocation.m_size = reqs.size;
+  allocation.m_range_offset = range->range_offset;
+  allocation.m_range_size = range->range_size;
+  allocation.m_mapped =
+      block.mapped == nullptr ? nullptr : block.mapped + range->offset;
+  return true;
+}
+
+MemoryAllocation MemoryAllocator::allocate(const VkMemoryRequirements &reqs,
+                                           VkMemoryPropertyFlags properties) {
+  const unsigned memory_type = find_memory_type(
+      m_memory_properties, reqs.memoryTypeBits, properties);
+
+  const std::lock_guard lock(m_mutex);
+  MemoryAllocation allocation;
+  for (auto &block : m_blocks[memory_type]) {
+    if (try_allocate(*block, reqs, allocation)) {
+      return allocation;
+    }
+  }
+
+  // small heaps (e.g. 256MB BAR) should not be eaten by a single block;
+  // requests bigger than half of a block get their own, exactly sized one
+  const unsigned heap =
+      m_memory_properties.memoryTypes[memory_type].heapIndex;
+  const VkDeviceSize block_size = std::min(
+      m_block_size, m_memory_properties.memoryHeaps[heap].size / 8);
+  Block &block = make_block(memory_type, reqs.size > block_size / 2
+                                             ? reqs.size
+                                             : block_size);
+  if (!try_allocate(block, reqs, allocation)) {
+    throw exceptions::MemoryAllocationError{};
+  }
+  return allocation;
+}
+
+void MemoryAllocator::free(MemoryAllocation &allocation) {
+  const std::lock_guard lock(m_mutex);
+  auto &block = *static_cast<Block *>(allocation.m_block);
+  block.wasted_bytes -= allocation.m_offset - allocation.m_range_offset;
+  --block.allocation_count;
+  block.free_list.release(allocation.m_range_offset, allocation.m_range_size);
+
+  allocation.m_allocator = nullptr;
+  allocation.m_block = nullptr;
+
+  // keep a single empty block per memory type around to avoid thrashing
+  auto &blocks = m_blocks[block.memory_type];
+  if (block.allocation_count == 0 && blocks.size() > 1) {
+    auto it = std::find_if(blocks.begin(), blocks.end(),
+                           [&block](const auto &b) { return b.get() == &block; });
+    if (it != blocks.end()) {
+      blocks.erase(it);
+    }
+  }
+}
+
+MemoryAllocator::Stats MemoryAllocator::stats() const {
+  const std::lock_guard lock(m_mutex);
+  Stats stats;
+  VkDeviceSize free_bytes = 0;
+  VkDeviceSize largest_free = 0;
+  for (const auto &blocks : m_blocks) {
+    for (const auto &block : blocks) {
+      ++stats.block_count;
+      stats.allocation_count += block->allocation_count;
+      stats.reserved_bytes += block->size;
+      stats.wasted_bytes += block->wasted_bytes;
+      const VkDeviceSize block_free = block->free_list.free_bytes();
+      largest_free = std::max(largest_free, block->free_list.largest_free());
+      free_bytes += block_free;
+      stats.used_bytes += block->size - block_free - block->wasted_bytes;
+    }
+  }
+  if (free_bytes != 0) {
+    stats.fragmentation = 1.0f - static_cast<float>(largest_free) /
+                                     static_cast<float>(free_bytes);
+  }
+  return stats;
+}
+
+} // namespace engine::core
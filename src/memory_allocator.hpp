@@ -0,0 +1,140 @@
+#pragma once
+
+#include "vulkan_destroyable.hpp" // for VkDestroyable, VkDeviceMemoryWrapper
+#include <array>                  // for array
+#include <cstddef>                // for size_t, byte
+#include <map>                    // for map
+#include <memory>                 // for unique_ptr
+#include <mutex>                  // for mutex
+#include <optional>               // for optional
+#include <utility>                // for move
+#include <vector>                 // for vector
+#include <vulkan/vulkan_core.h>   // for VkDeviceMemory, VkDeviceSize
+
+namespace engine::core {
+
+class MemoryAllocator;
+
+// First fit free list over the offsets [0, size), alignment aware, neighbours
+// coalesced on release. Bookkeeping only: it places device memory
+// allocations inside blocks as well as mesh data inside shared buffers.
+class FreeList {
+public:
+  struct Range {
+    VkDeviceSize offset = 0; // aligned start
+    // taken from the list, alignment padding included
+    VkDeviceSize range_offset = 0;
+    VkDeviceSize range_size = 0;
+  };
+
+  FreeList() = default;
+  explicit FreeList(VkDeviceSize size) { m_ranges.emplace(0, size); }
+
+  [[nodiscard]] std::optional<Range> allocate(VkDeviceSize size,
+                                              VkDeviceSize alignment);
+
+  // `range_offset` and `range_size` of a range `allocate` returned
+  void release(VkDeviceSize range_offset, VkDeviceSize range_size);
+
+  [[nodiscard]] VkDeviceSize free_bytes() const;
+  [[nodiscard]] VkDeviceSize largest_free() const;
+
+private:
+  // offset -> size of free ranges
+  std::map<VkDeviceSize, VkDeviceSize> m_ranges;
+};
+
+// Sub-range of a device memory block. Returns the range to the allocator on
+// destruction, so owners (e.g. `Buffer`) only have to keep it alive.
+class MemoryAllocation {
+private:
+  friend class MemoryAllocator;
+
+  MemoryAllocator *m_allocator = nullptr;
+  void *m_block = nullptr;
+  VkDeviceMemory m_memory = VK_NULL_HANDLE;
+  VkDeviceSize m_offset = 0;
+  VkDeviceSize m_size = 0;
+  // range actually taken from the block, including alignment padding
+  VkDeviceSize m_range_offset = 0;
+  VkDeviceSize m_range_size = 0;
+  std::byte *m_mapped = nullptr;
+
+public:
+  MemoryAllocation() = default;
+
+  [[nodiscard]] VkDeviceMemory memory() const { return m_memory; }
+  [[nodiscard]] VkDeviceSize offset() const { return m_offset; }
+  [[nodiscard]] VkDeviceSize size() const { return m_size; }
+  // non-null only for host visible memory, which is persistently mapped
+  [[nodiscard]] std::byte *mapped() const { return m_mapped; }
+
+  MemoryAllocation(const MemoryAllocation &) = delete;
+  MemoryAllocation &operator=(const MemoryAllocation &) = delete;
+
+  MemoryAllocation(MemoryAllocation &&other) noexcept {
+    *this = std::move(other);
+  }
+
+  MemoryAllocation &operator=(MemoryAllocation &&other) noexcept;
+
+  ~MemoryAllocation();
+};
+
+// Block based device memory allocator. Every memory type owns a list of large
+// `VkDeviceMemory` blocks, requests are sub-allocated from a per-block free
+// list (first fit, alignment aware, neighbours coalesced on free).
+class MemoryAllocator {
+public:
+  struct Stats {
+    std::size_t block_count = 0;
+    std::size_t allocation_count = 0;
+    VkDeviceSize reserved_bytes = 0; // sum of block sizes
+    VkDeviceSize used_bytes = 0;     // requested by allocations
+    VkDeviceSize wasted_bytes = 0;   // alignment padding
+    // 0 -- all free space is contiguous, close to 1 -- heavily fragmented
+    float fragmentation = 0.0f;
+  };
+
+  static constexpr VkDeviceSize DEFAULT_BLOCK_SIZE = 64ull << 20;
+
+  MemoryAllocator(VkDevice device, VkPhysicalDevice physical_device,
+                  VkDeviceSize block_size = DEFAULT_BLOCK_SIZE);
+
+  [[nodiscard]] MemoryAllocation allocate(const VkMemoryRequirements &reqs,
+                                          VkMemoryPropertyFlags properties);
+
+  [[nodiscard]] Stats stats() const;
+
+  MemoryAllocator(const MemoryAllocator &) = delete;
+  MemoryAllocator(MemoryAllocator &&) noexcept = delete;
+  MemoryAllocator &operator=(const MemoryAllocator &) = delete;
+  MemoryAllocator &operator=(MemoryAllocator &&) noexcept = delete;
+  ~MemoryAllocator() = default;
+
+private:
+  friend class MemoryAllocation;
+
+  struct Block {
+    VkDestroyable<VkDeviceMemoryWrapper> memory;
+    VkDeviceSize size = 0;
+    unsigned memory_type = 0;
+    std::byte *mapped = nullptr;
+    std::size_t allocation_count = 0;
+    VkDeviceSize wasted_bytes = 0;
+    FreeList free_list;
+  };
+
+  VkDevice m_device = VK_NULL_HANDLE;
+  VkPhysicalDeviceMemoryProperties m_memory_properties{};
+  VkDeviceSize m_block_size = DEFAULT_BLOCK_SIZE;
+  std::array<std::vector<std::unique_ptr<Block>>, VK_MAX_MEMORY_TYPES> m_blocks;
+  mutable std::mutex m_mutex;
+
+  Block &make_block(unsigned memory_type, VkDeviceSize size);
+  bool try_allocate(Block &block, const VkMemoryRequirements &reqs,
+                    MemoryAllocation &allocation);
+  void free(MemoryAllocation &allocation);
+};
+
+} // namespace engine::core
@@ -1,7 +1,8 @@
 #pragma once
 
+#include "buffer_arena.hpp"     // for ArenaRange
+#include "upload_scheduler.hpp" // for UploadHandle
 #include "vertex.hpp"           // for Vertex
-#include "vulkan_buffers.hpp"   // for Buffer, Renderer
 #include <cstddef>              // for size_t
 #include <span>                 // for span
 #include <vulkan/vulkan_core.h> // for VkPipeline
@@ -12,10 +13,14 @@ class Material;
 
 class Mesh {
 private:
-  core::Buffer m_vertices;
-  core::Buffer m_indices;
+  // ranges of the renderer's vertex and index arenas
+  core::ArenaRange m_vertices;
+  core::ArenaRange m_indices;
   unsigned m_indices_size = 0;
+  core::UploadHandle m_upload;
   const resources::Material *m_material = nullptr;
+  float m_sort_depth = 0.0f;
+  glm::vec4 m_bounding_sphere{0.0f};
 
 public:
   Mesh() = default;
@@ -23,10 +28,27 @@ public:
        std::span<unsigned> indices, const resources::Material *material);
 
   [[nodiscard]] std::size_t indices_size() const { return m_indices_size; }
-  [[nodiscard]] const core::Buffer &vertices() const { return m_vertices; }
-  [[nodiscard]] const core::Buffer &indices() const { return m_indices; }
+  [[nodiscard]] const core::ArenaRange &vertices() const { return m_vertices; }
+  [[nodiscard]] const core::ArenaRange &indices() const { return m_indices; }
+  // where the mesh starts in the shared buffers, in indices and vertices
+  [[nodiscard]] unsigned first_index() const {
+    return static_cast<unsigned>(m_indices.offset() / sizeof(unsigned));
+  }
+  [[nodiscard]] int vertex_offset() const {
+    return static_cast<int>(m_vertices.offset() / sizeof(Vertex));
+  }
   [[nodiscard]] VkPipeline pipeline() const;
+  // mesh may be drawn right away, this tells whether the GPU copy finished
+  [[nodiscard]] bool uploaded() const { return m_upload.complete(); }
   [[nodiscard]] const Material *material() const { return m_material; }
+
+  // view depth in [0, 1] used to order draws sharing the same state,
+  // nearer first
+  void set_sort_depth(float depth) { m_sort_depth = depth; }
+  [[nodiscard]] float sort_depth() const { return m_sort_depth; }
+
+  // center and radius in mesh space, encloses every vertex
+  [[nodiscard]] glm::vec4 bounding_sphere() const { return m_bounding_sphere; }
 };
 
 } // namespace engine::resources
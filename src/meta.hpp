@@ -19,6 +19,12 @@ inline static const std::filesystem::path PATH_TO_BINARIES =
 
 namespace core {
 
+inline static const std::filesystem::path PIPELINE_CACHE_PATH =
+    PATH_TO_BINARIES / "pipeline_cache.bin";
+
+inline static const std::filesystem::path CPU_TRACE_PATH =
+    PATH_TO_BINARIES / "cpu_trace.json";
+
 #ifndef NDEBUG
 static constexpr bool ENABLE_VALIDATION_LAYERS = true;
 #else
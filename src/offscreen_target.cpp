@@ -0,0 +1,87 @@
+#include "offscreen_target.hpp"
+#include "engine_exceptions.hpp" // for ImageCreationError, FramebufferCre...
+#include "swapchain.hpp"         // for make_image_view
+#include <algorithm>             // for max
+#include <array>                 // for array
+
+namespace engine::core {
+
+OffscreenTarget::OffscreenTarget(VkDevice device,
+                                 VkPhysicalDevice physical_device,
+                                 MemoryAllocator &allocator, VkExtent2D extent,
+                                 VkFormat format, std::size_t image_count)
+    : m_image_format(format), m_extent(extent), m_device(device) {
+  VkPhysicalDeviceProperties properties{};
+  vkGetPhysicalDeviceProperties(physical_device, &properties);
+  const VkDeviceSize granularity = properties.limits.bufferImageGranularity;
+
+  const VkImageCreateInfo create_info{
+      .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = 0,
+      .imageType = VK_IMAGE_TYPE_2D,
+      .format = format,
+      .extent = {extent.width, extent.height, 1},
+      .mipLevels = 1,
+      .arrayLayers = 1,
+      .samples = VK_SAMPLE_COUNT_1_BIT,
+      .tiling = VK_IMAGE_TILING_OPTIMAL,
+      .usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+               VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+      .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+      .queueFamilyIndexCount = 0,
+      .pQueueFamilyIndices = nullptr,
+      .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED};
+
+  for (std::size_t i = 0; i < image_count; ++i) {
+    VkImage image = VK_NULL_HANDLE;
+    if (vkCreateImage(device, &create_info, nullptr, &image) != VK_SUCCESS) {
+      throw exceptions::ImageCreationError{};
+    }
+    m_images.emplace_back(image, device);
+
+    // the allocator shares blocks with buffers, keeping the image on its own
+    // granularity pages prevents linear/optimal aliasing
+    VkMemoryRequirements requirements{};
+    vkGetImageMemoryRequirements(device, image, &requirements);
+    requirements.alignment = std::max(requirements.alignment, granularity);
+    requirements.size = (requirements.size + granularity - 1) /
+                        granularity * granularity;
+
+    m_allocations.push_back(
+        allocator.allocate(requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
+    vkBindImageMemory(device, image, m_allocations.back().memory(),
+                      m_allocations.back().offset());
+
+    m_image_views.emplace_back(
+        make_image_view(device, image, format, VK_IMAGE_ASPECT_COLOR_BIT),
+        device);
+  }
+}
+
+void OffscreenTarget::make_framebuffers(VkRenderPass render_pass) {
+  for (VkImageView image_view : m_image_views) {
+    const std::array<VkImageView, 1> attachments = {image_view};
+
+    const VkFramebufferCreateInfo create_info{
+        .sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .renderPass = render_pass,
+        .attachmentCount = static_cast<unsigned>(attachments.size()),
+        .pAttachments = attachments.data(),
+        .width = m_extent.width,
+        .height = m_extent.height,
+        .layers = 1};
+
+    VkFramebuffer framebuffer = VK_NULL_HANDLE;
+    if (vkCreateFramebuffer(m_device, &create_info, nullptr, &framebuffer) !=
+        VK_SUCCESS) {
+      throw exceptions::FramebufferCreationError{};
+    }
+
+    m_framebuffers.emplace_back(framebuffer, m_device);
+  }
+}
+
+} // namespace engine::core
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "memory_allocator.hpp"   // for MemoryAllocation, MemoryAllocator
+#include "vulkan_destroyable.hpp" // for VkDestroyable, VkImageWrapper, VkI...
+#include <cstddef>                // for size_t
+#include <vector>                 // for vector
+#include <vulkan/vulkan_core.h>   // for VkDevice, VkExtent2D, VkFormat
+
+namespace engine::core {
+
+// Color images rendered into instead of swapchain images when there is no
+// window. One image per frame in flight, so frames never wait on each other.
+class OffscreenTarget {
+private:
+  VkFormat m_image_format{};
+  VkExtent2D m_extent{};
+  VkDevice m_device = VK_NULL_HANDLE;
+  std::vector<MemoryAllocation> m_allocations;
+  std::vector<VkDestroyable<VkImageWrapper>> m_images;
+  std::vector<VkDestroyable<VkImageViewWrapper>> m_image_views;
+  std::vector<VkDestroyable<VkFramebufferWrapper>> m_framebuffers;
+
+public:
+  OffscreenTarget(VkDevice device, VkPhysicalDevice physical_device,
+                  MemoryAllocator &allocator, VkExtent2D extent,
+                  VkFormat format, std::size_t image_count);
+
+  // once render pass created, it bootstraps framebuffers
+  void make_framebuffers(VkRenderPass render_pass);
+
+  [[nodiscard]] VkFormat image_format() const { return m_image_format; }
+  [[nodiscard]] VkExtent2D extent() const { return m_extent; }
+  [[nodiscard]] const std::vector<VkDestroyable<VkFramebufferWrapper>> &
+  framebuffers() const {
+    return m_framebuffers;
+  }
+};
+
+} // namespace engine::core
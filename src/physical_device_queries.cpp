@@ -31,7 +31,12 @@ find_graphics_present_queue_families(VkPhysicalDevice device,
     }
 
     VkBool32 present = false;
-    vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &present);
+    if (surface != VK_NULL_HANDLE) {
+      vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &present);
+    } else {
+      // headless: nothing is presented, the graphics queue stands in
+      present = (families[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0;
+    }
     if (present) {
       ind.present_family = i;
     }
@@ -43,7 +48,11 @@ find_graphics_present_queue_families(VkPhysicalDevice device,
   return ind;
 }
 
-bool is_device_extensions_supported(VkPhysicalDevice device) {
+bool is_device_extensions_supported(VkPhysicalDevice device, bool headless) {
+  if (headless) {
+    return true;
+  }
+
   unsigned count = 0;
   vkEnumerateDeviceExtensionProperties(device, nullptr, &count, nullptr);
   std::vector<VkExtensionProperties> extensions(count);
@@ -105,7 +114,8 @@ VkPhysicalDevice choose_physical_device(VkInstance instance,
 
   auto suitable = [surface](VkPhysicalDevice device) -> bool {
     const auto ind = find_queue_families(device, surface);
-    const bool extensions_support = is_device_extensions_supported(device);
+    const bool extensions_support =
+        is_device_extensions_supported(device, surface == VK_NULL_HANDLE);
     VkPhysicalDeviceFeatures supported_features{};
     vkGetPhysicalDeviceFeatures(device, &supported_features);
     return ind.present_family && ind.graphics_family && extensions_support &&
@@ -123,7 +133,12 @@ unsigned find_memory_type(VkPhysicalDevice device, unsigned type_filter,
                           VkMemoryPropertyFlags properties) {
   VkPhysicalDeviceMemoryProperties mem_properties{};
   vkGetPhysicalDeviceMemoryProperties(device, &mem_properties);
+  return find_memory_type(mem_properties, type_filter, properties);
+}
 
+unsigned find_memory_type(const VkPhysicalDeviceMemoryProperties &mem_properties,
+                          unsigned type_filter,
+                          VkMemoryPropertyFlags properties) {
   for (unsigned i = 0; i < mem_properties.memoryTypeCount; i++) {
     if (type_filter & (1 << i) && (mem_properties.memoryTypes[i].propertyFlags &
                                    properties) == properties) {
@@ -10,11 +10,16 @@ struct QueueFamilyIndices {
   std::optional<unsigned> transfer_family;
 };
 
+// `surface` may be VK_NULL_HANDLE for headless rendering, the graphics
+// family is reported as the present one then
 QueueFamilyIndices find_queue_families(VkPhysicalDevice device,
                                        VkSurfaceKHR surface);
 VkPhysicalDevice choose_physical_device(VkInstance instance,
                                         VkSurfaceKHR surface);
 unsigned find_memory_type(VkPhysicalDevice device, unsigned type_filter,
                           VkMemoryPropertyFlags properties);
+unsigned find_memory_type(const VkPhysicalDeviceMemoryProperties &mem_properties,
+                          unsigned type_filter,
+                          VkMemoryPropertyFlags properties);
 
 } // namespace engine::core
@@ -0,0 +1,160 @@
+#include "pipeline_cache.hpp"
+#include "engine_exceptions.hpp" // for PipelineCacheCreationError
+#include <algorithm>             // for equal
+#include <cstddef>               // for size_t
+#include <cstdint>               // for uint32_t, uint64_t, uintmax_t
+#include <cstdio>                // for stderr
+#include <filesystem>            // for file_size
+#include <fstream>               // for ifstream, ofstream
+#include <iterator>              // for begin, end
+#include <print>                 // for println
+#include <system_error>          // for error_code
+#include <utility>               // for move
+#include <vector>                // for vector
+
+namespace engine::core {
+
+namespace {
+
+constexpr std::uint32_t CACHE_MAGIC = 0x50434b56; // "VKCP"
+
+struct CacheFileHeader {
+  std::uint32_t magic = CACHE_MAGIC;
+  std::uint32_t vendor_id = 0;
+  std::uint32_t device_id = 0;
+  std::uint32_t driver_version = 0;
+  std::uint8_t uuid[VK_UUID_SIZE] = {};
+  std::uint64_t data_size = 0;
+};
+
+CacheFileHeader make_header(const VkPhysicalDeviceProperties &properties) {
+  CacheFileHeader header{.magic = CACHE_MAGIC,
+                         .vendor_id = properties.vendorID,
+                         .device_id = properties.deviceID,
+                         .driver_version = properties.driverVersion,
+                         .uuid = {},
+                         .data_size = 0};
+  std::copy(std::begin(properties.pipelineCacheUUID),
+            std::end(properties.pipelineCacheUUID), std::begin(header.uuid));
+  return header;
+}
+
+// returns cache blob if the file was written for this very device and driver
+std::vector<char> read_cache_blob(const std::filesystem::path &path,
+                                  const VkPhysicalDeviceProperties &props) {
+  std::error_code error;
+  const std::uintmax_t file_size = std::filesystem::file_size(path, error);
+  std::ifstream file(path, std::ios::binary);
+  if (error || !file) {
+    return {};
+  }
+
+  CacheFileHeader header{};
+  // NOLINTNEXTLINE
+  file.read(reinterpret_cast<char *>(&header), sizeof(header));
+  const CacheFileHeader expected = make_header(props);
+  if (!file || header.magic != expected.magic ||
+      header.vendor_id != expected.vendor_id ||
+      header.device_id != expected.device_id ||
+      header.driver_version != expected.driver_version ||
+      !std::equal(std::begin(header.uuid), std::end(header.uuid),
+                  std::begin(expected.uuid))) {
+    std::println(stderr, "Pipeline cache {} is stale, ignoring it",
+                 path.string());
+    return {};
+  }
+
+  // a truncated or padded file means an interrupted or foreign write, and the
+  // size must not be trusted before allocating for it
+  if (file_size < sizeof(header) ||
+      header.data_size != file_size - sizeof(header)) {
+    std::println(stderr, "Pipeline cache {} is corrupt, ignoring it",
+                 path.string());
+    return {};
+  }
+
+  std::vector<char> blob(static_cast<std::size_t>(header.data_size));
+  file.read(blob.data(), static_cast<std::streamsize>(blob.size()));
+  if (!file) {
+    return {};
+  }
+
+  // the driver validates its own header too, but refusing obviously broken
+  // blobs here keeps bad data away from buggy drivers
+  VkPipelineCacheHeaderVersionOne vk_header{};
+  if (blob.size() < sizeof(vk_header)) {
+    return {};
+  }
+  std::copy_n(blob.data(), sizeof(vk_header),
+              reinterpret_cast<char *>(&vk_header)); // NOLINT
+  if (vk_header.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE ||
+      vk_header.vendorID != props.vendorID ||
+      vk_header.deviceID != props.deviceID) {
+    return {};
+  }
+  return blob;
+}
+
+} // namespace
+
+PipelineCache::PipelineCache(VkDevice device, VkPhysicalDevice physical_device,
+                             std::filesystem::path path)
+    : m_device(device), m_path(std::move(path)) {
+  vkGetPhysicalDeviceProperties(physical_device, &m_properties);
+  const std::vector<char> blob = read_cache_blob(m_path, m_properties);
+
+  const VkPipelineCacheCreateInfo create_info{
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = 0,
+      .initialDataSize = blob.size(),
+      .pInitialData = blob.empty() ? nullptr : blob.data()};
+
+  VkPipelineCache cache = VK_NULL_HANDLE;
+  if (vkCreatePipelineCache(device, &create_info, nullptr, &cache) !=
+      VK_SUCCESS) {
+    throw exceptions::PipelineCacheCreationError{};
+  }
+  m_cache = {cache, device};
+}
+
+bool PipelineCache::save() const {
+  std::size_t size = 0;
+  if (vkGetPipelineCacheData(m_device, m_cache, &size, nullptr) !=
+      VK_SUCCESS) {
+    return false;
+  }
+  std::vector<char> blob(size);
+  if (vkGetPipelineCacheData(m_device, m_cache, &size, blob.data()) !=
+      VK_SUCCESS) {
+    return false;
+  }
+
+  CacheFileHeader header = make_header(m_properties);
+  header.data_size = size;
+
+  // write to a temporary file first, so a crash never leaves a torn cache
+  std::filesystem::path tmp_path = m_path;
+  tmp_path += ".tmp";
+  {
+    std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+    // NOLINTNEXTLINE
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(blob.data(), static_cast<std::streamsize>(size));
+    if (!file) {
+      return false;
+    }
+  }
+  std::error_code ec;
+  std::filesystem::rename(tmp_path, m_path, ec);
+  return !ec;
+}
+
+PipelineCache::~PipelineCache() {
+  if (m_cache.get_underlying() != VK_NULL_HANDLE && !save()) {
+    std::println(stderr, "WARNING: failed to save pipeline cache to {}",
+                 m_path.string());
+  }
+}
+
+} // namespace engine::core
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "vulkan_destroyable.hpp" // for VkDestroyable, VkPipelineCacheWrapper
+#include <filesystem>             // for path
+#include <vulkan/vulkan_core.h>   // for VkPipelineCache, VkDevice
+
+namespace engine::core {
+
+// Renderer-wide `VkPipelineCache` persisted between launches. The blob on
+// disk is prefixed with the device identity and driver version; a blob from
+// another GPU or driver is ignored and the cache starts empty.
+class PipelineCache {
+private:
+  VkDestroyable<VkPipelineCacheWrapper> m_cache;
+  VkDevice m_device = VK_NULL_HANDLE;
+  VkPhysicalDeviceProperties m_properties{};
+  std::filesystem::path m_path;
+
+public:
+  PipelineCache(VkDevice device, VkPhysicalDevice physical_device,
+                std::filesystem::path path);
+
+  // writes current cache contents to disk, returns false on failure
+  bool save() const;
+
+  [[nodiscard]] VkPipelineCache cache() const { return m_cache; }
+
+  PipelineCache(const PipelineCache &) = delete;
+  PipelineCache(PipelineCache &&) noexcept = delete;
+  PipelineCache &operator=(const PipelineCache &) = delete;
+  PipelineCache &operator=(PipelineCache &&) noexcept = delete;
+
+  ~PipelineCache();
+};
+
+} // namespace engine::core
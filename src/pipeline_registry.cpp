@@ -0,0 +1,127 @@
+#include "pipeline_registry.hpp"
+#include "cpu_profiler.hpp"       // for CpuScope
+#include "hash.hpp"               // for StateKey
+#include "rendering_pipeline.hpp" // for PipelineLayoutMaker, RenderingPipel...
+#include "thread_pool.hpp"        // for ThreadPool
+#include <exception>              // for current_exception, rethrow_exception
+#include <future>                 // for promise
+#include <span>                   // for as_bytes, span
+#include <utility>                // for move
+
+namespace engine::core {
+
+StateKey
+PipelineRegistry::make_key(const PipelineLayoutMaker &layout_maker,
+                           const RenderingPipelineMaker &pipeline_maker,
+                           VkRenderPass render_pass) {
+  StateKey key;
+  key.add(layout_maker.state_key())
+      .add(pipeline_maker.state_key())
+      .add(std::as_bytes(std::span(&render_pass, 1)));
+  return key;
+}
+
+SharedPipeline PipelineRegistry::build(const StateKey &key,
+                                       const PipelineLayoutMaker &layout_maker,
+                                       RenderingPipelineMaker &pipeline_maker,
+                                       VkRenderPass render_pass) {
+  const CpuScope scope("build pipeline");
+  // compile outside of the lock, other threads may build other pipelines
+  auto pipeline = std::make_shared<Pipeline>();
+  try {
+    pipeline->layout = layout_maker.make_pipeline_layout();
+    pipeline->pipeline = pipeline_maker.set_pipeline_layout(pipeline->layout)
+                             .make_rendering_pipeline(render_pass, m_cache);
+  } catch (...) {
+    const std::lock_guard lock(m_mutex);
+    auto &entry = m_pipelines[key];
+    entry.pending = {};
+    entry.error = std::current_exception();
+    throw;
+  }
+  pipeline->key = key.hash();
+
+  const std::lock_guard lock(m_mutex);
+  auto &entry = m_pipelines[key];
+  entry.pending = {};
+  if (auto existing = entry.pipeline.lock()) {
+    // lost the race against a concurrent build of the same state
+    ++m_hits;
+    return existing;
+  }
+  ++m_misses;
+  SharedPipeline shared = std::move(pipeline);
+  entry.pipeline = shared;
+  return shared;
+}
+
+SharedPipeline PipelineRegistry::acquire(const PipelineLayoutMaker &layout_maker,
+                                         RenderingPipelineMaker &pipeline_maker,
+                                         VkRenderPass render_pass) {
+  const StateKey key = make_key(layout_maker, pipeline_maker, render_pass);
+
+  PipelineFuture pending;
+  {
+    const std::lock_guard lock(m_mutex);
+    if (auto it = m_pipelines.find(key); it != m_pipelines.end()) {
+      if (auto pipeline = it->second.pipeline.lock()) {
+        ++m_hits;
+        return pipeline;
+      }
+      if (it->second.error) {
+        std::rethrow_exception(it->second.error);
+      }
+      pending = it->second.pending;
+    }
+  }
+  if (pending.valid()) {
+    return pending.get();
+  }
+  return build(key, layout_maker, pipeline_maker, render_pass);
+}
+
+PipelineFuture
+PipelineRegistry::acquire_async(PipelineLayoutMaker layout_maker,
+                                RenderingPipelineMaker pipeline_maker,
+                                VkRenderPass render_pass) {
+  const StateKey key = make_key(layout_maker, pipeline_maker, render_pass);
+
+  const std::lock_guard lock(m_mutex);
+  auto &entry = m_pipelines[key];
+  if (auto pipeline = entry.pipeline.lock()) {
+    ++m_hits;
+    std::promise<SharedPipeline> ready;
+    ready.set_value(std::move(pipeline));
+    return ready.get_future().share();
+  }
+  if (entry.error) {
+    std::promise<SharedPipeline> failed;
+    failed.set_exception(entry.error);
+    return failed.get_future().share();
+  }
+  if (entry.pending.valid()) {
+    ++m_hits;
+    return entry.pending;
+  }
+
+  entry.pending =
+      m_workers
+          ->submit([this, key, layout_maker = std::move(layout_maker),
+                    pipeline_maker = std::move(pipeline_maker),
+                    render_pass]() mutable {
+            return build(key, layout_maker, pipeline_maker, render_pass);
+          })
+          .share();
+  return entry.pending;
+}
+
+PipelineRegistry::Stats PipelineRegistry::stats() const {
+  const std::lock_guard lock(m_mutex);
+  Stats stats{.hits = m_hits, .misses = m_misses, .live_pipelines = 0};
+  for (const auto &[key, entry] : m_pipelines) {
+    stats.live_pipelines += entry.pipeline.expired() ? 0 : 1;
+  }
+  return stats;
+}
+
+} // namespace engine::core
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "hash.hpp"               // for StateKey, StateKeyHash
+#include "vulkan_destroyable.hpp" // for VkDestroyable, VkPipelineWrapper
+#include <cstddef>                // for size_t
+#include <cstdint>                // for uint64_t
+#include <exception>              // for exception_ptr
+#include <future>                 // for shared_future
+#include <memory>                 // for shared_ptr, weak_ptr
+#include <mutex>                  // for mutex
+#include <unordered_map>          // for unordered_map
+#include <vulkan/vulkan_core.h>   // for VkPipeline, VkPipelineLayout
+
+namespace engine::core {
+
+class PipelineLayoutMaker;
+class RenderingPipelineMaker;
+class ThreadPool;
+
+struct Pipeline {
+  VkDestroyable<VkPipelineLayoutWrapper> layout;
+  VkDestroyable<VkPipelineWrapper> pipeline;
+  std::uint64_t key = 0; // hash of the creation state, for sorting draws
+};
+
+// shared between every user with the same creation state, the pipeline is
+// destroyed together with the last reference
+using SharedPipeline = std::shared_ptr<const Pipeline>;
+using PipelineFuture = std::shared_future<SharedPipeline>;
+
+// Deduplicates pipelines (together with their layouts) by their full creation
+// state, so identical materials share one `VkPipeline`. Builds of the
+// same state which are already in flight are joined rather than repeated.
+// A failed build is remembered, later requests for its state fail with the
+// same error instead of compiling again.
+class PipelineRegistry {
+public:
+  struct Stats {
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+    std::size_t live_pipelines = 0;
+  };
+
+  PipelineRegistry(VkDevice device, VkPipelineCache cache, ThreadPool &workers)
+      : m_device(device), m_cache(cache), m_workers(&workers) {}
+
+  // blocks until the pipeline is built, rethrows a failed build;
+  // `pipeline_maker` gets the layout assigned on a miss
+  [[nodiscard]] SharedPipeline acquire(const PipelineLayoutMaker &layout_maker,
+                                       RenderingPipelineMaker &pipeline_maker,
+                                       VkRenderPass render_pass);
+
+  // compiles on the worker pool, a hit returns an already satisfied future;
+  // a failed build's future holds its exception
+  [[nodiscard]] PipelineFuture
+  acquire_async(PipelineLayoutMaker layout_maker,
+                RenderingPipelineMaker pipeline_maker, VkRenderPass render_pass);
+
+  [[nodiscard]] Stats stats() const;
+
+  PipelineRegistry(const PipelineRegistry &) = delete;
+  PipelineRegistry(PipelineRegistry &&) noexcept = delete;
+  PipelineRegistry &operator=(const PipelineRegistry &) = delete;
+  PipelineRegistry &operator=(PipelineRegistry &&) noexcept = delete;
+  ~PipelineRegistry() = default;
+
+private:
+  struct Entry {
+    std::weak_ptr<const Pipeline> pipeline;
+    // set while the pipeline is being compiled on the worker pool
+    PipelineFuture pending;
+    std::exception_ptr error; // set once a build of the state has failed
+  };
+
+  VkDevice m_device = VK_NULL_HANDLE;
+  VkPipelineCache m_cache = VK_NULL_HANDLE;
+  ThreadPool *m_workers = nullptr;
+  std::unordered_map<StateKey, Entry, StateKeyHash> m_pipelines;
+  std::size_t m_hits = 0;
+  std::size_t m_misses = 0;
+  mutable std::mutex m_mutex;
+
+  static StateKey make_key(const PipelineLayoutMaker &layout_maker,
+                                const RenderingPipelineMaker &pipeline_maker,
+                                VkRenderPass render_pass);
+
+  // builds the pipeline and publishes it, keeping an existing live one; on
+  // failure the error is stored on the entry and rethrown
+  SharedPipeline build(const StateKey &key,
+                       const PipelineLayoutMaker &layout_maker,
+                       RenderingPipelineMaker &pipeline_maker,
+                       VkRenderPass render_pass);
+};
+
+} // namespace engine::core
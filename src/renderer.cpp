@@ -1,27 +1,34 @@
 #include "renderer.hpp"
 #include "SDL3/SDL_error.h"            // for SDL_GetError
 #include "SDL3/SDL_video.h"            // for SDL_Window
+#include "cpu_profiler.hpp"            // for CpuScope
 #include "engine_exceptions.hpp"       // for AcquireWindowExtensionsError
 #include "material.hpp"                // for Material
 #include "mesh.hpp"                    // for Mesh
-#include "meta.hpp"                    // for VALIDATION_LAYERS, ENABLE_VAL...
+#include "meta.hpp"                    // for VALIDATION_LAYERS, PIPELINE_C...
 #include "physical_device_queries.hpp" // for QueueFamilyIndices, choose_ph...
-#include "synchronization.hpp"         // for Semaphore, Fence
+#include "synchronization.hpp"         // for Semaphore, TimelineSemaphore
 #include "vulkan_buffers.hpp"          // for Buffer
 #include "window.hpp"                  // for Window
 #include <SDL3/SDL_vulkan.h>           // for SDL_Vulkan_CreateSurface, SDL...
-#include <algorithm>                   // for all_of, find_if
+#include <algorithm>                   // for all_of, clamp, find_if, max, min
 #include <array>                       // for array
 #include <cassert>                     // for assert
+#include <cstddef>                     // for byte, size_t
 #include <cstdint>                     // for uint64_t
 #include <cstdio>                      // for stderr
-#include <cstring>                     // for strcmp
+#include <cstring>                     // for memcpy, strcmp
+#include <exception>                   // for exception_ptr, rethrow_exception
+#include <format>                      // for format
+#include <future>                      // for future
 #include <limits>                      // for numeric_limits
+#include <numeric>                     // for iota
 #include <optional>                    // for optional
 #include <print>                       // for println
 #include <set>                         // for set, _Rb_tree_const_iterator
 #include <span>                        // for span
-#include <vector>                      // for vector
+#include <utility>                     // for in_place
+#include <vector>                      // for vector, erase, erase_if
 #include <vulkan/vk_platform.h>        // for VKAPI_ATTR, VKAPI_CALL
 #include <vulkan/vulkan_core.h>        // for VkStructureType, VkResult
 
@@ -66,7 +73,7 @@ bool validation_layers_supported() {
       });
 }
 
-VkInstance make_instance() {
+VkInstance make_instance(bool headless) {
   VkInstance instance = VK_NULL_HANDLE;
   if constexpr (ENABLE_VALIDATION_LAYERS) {
     if (!validation_layers_supported()) {
@@ -95,16 +102,17 @@ VkInstance make_instance() {
       .ppEnabledExtensionNames = nullptr,
   };
 
-  unsigned window_ext_count = 0;
-  auto window_ext_names_ptr =
-      SDL_Vulkan_GetInstanceExtensions(&window_ext_count);
-  if (!window_ext_names_ptr) {
-    throw exceptions::AcquireWindowExtensionsError{};
+  std::vector<const char *> required_ext_names;
+  if (!headless) {
+    unsigned window_ext_count = 0;
+    auto window_ext_names_ptr =
+        SDL_Vulkan_GetInstanceExtensions(&window_ext_count);
+    if (!window_ext_names_ptr) {
+      throw exceptions::AcquireWindowExtensionsError{};
+    }
+    auto window_ext_names = std::span(window_ext_names_ptr, window_ext_count);
+    required_ext_names.assign(window_ext_names.begin(), window_ext_names.end());
   }
-  auto window_ext_names = std::span(window_ext_names_ptr, window_ext_count);
-
-  std::vector<const char *> required_ext_names(window_ext_names.begin(),
-                                               window_ext_names.end());
   if constexpr (ENABLE_VALIDATION_LAYERS) {
     required_ext_names.emplace_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
   }
@@ -159,9 +167,12 @@ VkDebugUtilsMessengerEXT make_debug_messenger(VkInstance instance) {
   return debug_messenger;
 }
 
-VkSurfaceKHR make_surface(VkInstance instance, SDL_Window *window) {
+VkSurfaceKHR make_surface(VkInstance instance, const Window *window) {
   VkSurfaceKHR surface = VK_NULL_HANDLE;
-  if (!SDL_Vulkan_CreateSurface(window, instance, nullptr, &surface)) {
+  if (window == nullptr) {
+    return surface;
+  }
+  if (!SDL_Vulkan_CreateSurface(window->handle, instance, nullptr, &surface)) {
     throw exceptions::SurfaceCreationError(SDL_GetError());
   }
   return surface;
@@ -188,18 +199,30 @@ VkDevice make_logical_device(VkPhysicalDevice physical_device,
     queue_create_infos.emplace_back(info);
   }
 
+  VkPhysicalDeviceFeatures supported_features{};
+  vkGetPhysicalDeviceFeatures(physical_device, &supported_features);
+
   VkPhysicalDeviceFeatures features{};
   features.samplerAnisotropy = VK_TRUE;
+  // optional, indirect draws fall back to one command per call
+  features.multiDrawIndirect = supported_features.multiDrawIndirect;
+
+  VkPhysicalDeviceVulkan12Features features_12{
+      .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES};
+  // required by Vulkan 1.2, frames and uploads are tracked with it
+  features_12.timelineSemaphore = VK_TRUE;
 
   VkDeviceCreateInfo create_info{
       .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
-      .pNext = nullptr,
+      .pNext = &features_12,
       .flags = 0,
       .queueCreateInfoCount = static_cast<unsigned>(queue_create_infos.size()),
       .pQueueCreateInfos = queue_create_infos.data(),
       .enabledLayerCount = 0,
       .ppEnabledLayerNames = nullptr,
-      .enabledExtensionCount = DEVICE_EXTENSIONS.size(),
+      // headless rendering needs no swapchain
+      .enabledExtensionCount =
+          surface != VK_NULL_HANDLE ? DEVICE_EXTENSIONS.size() : 0,
       .ppEnabledExtensionNames = DEVICE_EXTENSIONS.data(),
       .pEnabledFeatures = &features,
   };
@@ -217,17 +240,20 @@ VkDevice make_logical_device(VkPhysicalDevice physical_device,
   return device;
 }
 
-VkRenderPass make_render_pass(VkDevice device, Swapchain &swapchain) {
+// offscreen images are left ready to be copied out
+VkRenderPass make_render_pass(VkDevice device, VkFormat format,
+                              bool presented) {
   const VkAttachmentDescription color_attachment{
       .flags = 0,
-      .format = swapchain.image_format(),
+      .format = format,
       .samples = VK_SAMPLE_COUNT_1_BIT,
       .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
       .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
       .stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
       .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
       .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-      .finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR};
+      .finalLayout = presented ? VK_IMAGE_LAYOUT_PRESENT_SRC_KHR
+                               : VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL};
 
   const VkAttachmentReference color_attachment_reference{
       .attachment = 0, .layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
@@ -287,10 +313,34 @@ VkRenderPass make_render_pass(VkDevice device, Swapchain &swapchain) {
       VK_SUCCESS) {
     throw exceptions::RenderPassCreationError{};
   }
-  swapchain.make_framebuffers(render_pass);
   return render_pass;
 }
 
+std::optional<Swapchain> make_swapchain(VkDevice device,
+                                        VkPhysicalDevice physical_device,
+                                        VkSurfaceKHR surface,
+                                        const Window *window,
+                                        const PresentPolicy &policy) {
+  if (window == nullptr) {
+    return std::nullopt;
+  }
+  return std::optional<Swapchain>(std::in_place, device, physical_device,
+                                  surface, *window, policy);
+}
+
+std::optional<OffscreenTarget>
+make_offscreen_target(VkDevice device, VkPhysicalDevice physical_device,
+                      MemoryAllocator &allocator, const Window *window,
+                      VkExtent2D extent, std::size_t image_count) {
+  if (window != nullptr) {
+    return std::nullopt;
+  }
+  // a format every implementation supports as a color attachment
+  return std::optional<OffscreenTarget>(std::in_place, device,
+                                        physical_device, allocator, extent,
+                                        VK_FORMAT_R8G8B8A8_UNORM, image_count);
+}
+
 } // namespace
 
 void DestroyDebugUtilsMessengerEXT(VkInstance instance,
@@ -304,23 +354,56 @@ void DestroyDebugUtilsMessengerEXT(VkInstance instance,
   }
 }
 
-Renderer::Renderer(Window &window)
-    : m_current_frame(0), m_window(window), m_instance(make_instance()),
+Renderer::Renderer(Window &window, const PresentPolicy &present_policy)
+    : Renderer(&window, {}, present_policy) {}
+
+Renderer::Renderer(VkExtent2D offscreen_extent)
+    : Renderer(nullptr, offscreen_extent, {}) {}
+
+Renderer::Renderer(Window *window, VkExtent2D offscreen_extent,
+                   const PresentPolicy &present_policy)
+    : m_current_frame(0), m_window(window),
+      m_instance(make_instance(window == nullptr)),
       m_debug_messenger(make_debug_messenger(m_instance), m_instance),
-      m_surface(make_surface(m_instance, window.handle), m_instance),
+      m_surface(make_surface(m_instance, window), m_instance),
       m_physical_device(choose_physical_device(m_instance, m_surface)),
       m_device(make_logical_device(m_physical_device, m_surface)),
+      m_allocator(m_device, m_physical_device),
+      m_pipeline_cache(m_device, m_physical_device, PIPELINE_CACHE_PATH),
+      m_shaders(m_device),
+      m_pipelines(m_device, m_pipeline_cache.cache(), m_workers),
       m_graphics_queue(m_physical_device, m_surface, m_device,
                        CommandQueue::Kind::GRAPHICS),
       m_present_queue(m_physical_device, m_surface, m_device,
                       CommandQueue::Kind::PRESENT),
       m_transfer_queue(m_physical_device, m_surface, m_device,
                        CommandQueue::Kind::TRANSFER),
-      m_swapchain(m_device, m_physical_device, m_surface, window),
-      m_render_pass(make_render_pass(m_device, m_swapchain), m_device),
+      m_gpu_profiler(m_device, m_physical_device, m_graphics_queue.index(),
+                     MAX_FRAMES_IN_FLIGHT),
+      m_swapchain(
+          make_swapchain(m_device, m_physical_device, m_surface, window,
+                         present_policy)),
+      m_offscreen(make_offscreen_target(m_device, m_physical_device,
+                                        m_allocator, window, offscreen_extent,
+                                        MAX_FRAMES_IN_FLIGHT)),
+      m_present_policy(present_policy),
+      m_render_pass(
+          make_render_pass(m_device, color_format(), window != nullptr),
+          m_device),
       /*m_pipeline_layout(make_default_pipeline_layout(m_device)),*/
-      m_command_pool(m_device, m_physical_device, m_surface),
-      m_transfer_command_pool(m_device, m_physical_device, m_surface, true) {
+      m_transfer_command_pool(m_device, m_physical_device, m_surface, true),
+      m_staging_ring(*this), m_uploads(*this),
+      m_vertex_arena(*this, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT),
+      m_index_arena(*this, VK_BUFFER_USAGE_INDEX_BUFFER_BIT),
+      m_frame_timeline(m_device), m_instance_set_layout_maker(m_device) {
+  if (m_swapchain) {
+    m_swapchain->make_framebuffers(m_render_pass);
+    m_window_extent = {static_cast<unsigned>(window->width),
+                       static_cast<unsigned>(window->height)};
+  } else {
+    m_offscreen->make_framebuffers(m_render_pass);
+  }
+
   /*RenderingPipelineMaker pipeline_maker(m_device);*/
   /*m_pipeline =*/
   /*    pipeline_maker.set_pipeline_layout(m_pipeline_layout)*/
@@ -341,22 +424,18 @@ Renderer::Renderer(Window &window)
   /*                      resources::Vertex::attribute_description().size()))*/
   /*        .make_rendering_pipeline(m_render_pass);*/
 
-  for (auto &semaphore : m_swapchain_semaphores) {
-    semaphore = Semaphore(m_device);
-  }
-  for (auto &semaphore : m_render_semaphores) {
-    semaphore = Semaphore(m_device);
-  }
-  for (auto &fence : m_render_fences) {
-    fence = Fence(m_device);
-  }
+  make_instance_sets();
 
-  const auto &vec_command_buffers =
-      m_command_pool.make_command_buffers(FRAME_OVERLAP);
-  for (std::size_t i = 0; i < FRAME_OVERLAP; ++i) {
-    m_command_buffers[i] = vec_command_buffers[i];
+  VkPhysicalDeviceFeatures features{};
+  vkGetPhysicalDeviceFeatures(m_physical_device, &features);
+  m_multi_draw_indirect = features.multiDrawIndirect == VK_TRUE;
+  // culled runs are one indirect call of many commands
+  if (m_multi_draw_indirect) {
+    m_culler.emplace(*this, MAX_FRAMES_IN_FLIGHT);
   }
 
+  make_frame_resources(DEFAULT_FRAMES_IN_FLIGHT);
+
   /*std::vector<resources::Vertex> vertices = {*/
   /*    {{-0.5f, -0.5f, 0.0f}, {}, {}, {1.0f, 0.0f, 1.0f, 1.0f}},*/
   /*    {{0.5f, -0.5f, 0.0f}, {}, {}, {0.0f, 1.0f, 1.0f, 1.0f}},*/
@@ -368,125 +447,813 @@ Renderer::Renderer(Window &window)
   /*m_meshes.emplace_back(*this, vertices, indices);*/
 }
 
-void Renderer::render_frame() {
-  m_render_fences[m_current_frame].wait();
+void Renderer::record_frame(
+    VkCommandBuffer command_buffer, unsigned image_index,
+    const UploadScheduler::FrameDependencies &uploads) {
+  // results of this slot's previous frame are ready, it was waited on
+  m_gpu_profiler.begin_frame(command_buffer, m_current_frame);
+  const GpuProfiler::Scope frame_scope(m_gpu_profiler, command_buffer,
+                                       "frame");
 
-  unsigned image_index = 0;
-  const VkResult acquire_result =
-      vkAcquireNextImageKHR(m_device, m_swapchain.swapchain(),
-                            std::numeric_limits<std::uint64_t>::max(),
-                            m_swapchain_semaphores[m_current_frame].semaphore(),
-                            VK_NULL_HANDLE, &image_index);
+  // take ownership of buffers released by the transfer queue
+  if (!uploads.acquires.empty()) {
+    vkCmdPipelineBarrier(command_buffer, uploads.acquire_stages,
+                         uploads.acquire_stages, 0, 0, nullptr,
+                         static_cast<unsigned>(uploads.acquires.size()),
+                         uploads.acquires.data(), 0, nullptr);
+  }
 
-  switch (acquire_result) {
-  case VK_ERROR_OUT_OF_DATE_KHR:
-    vkDeviceWaitIdle(m_device);
-    m_swapchain = Swapchain(m_device, m_physical_device, m_surface, m_window,
-                            m_render_pass);
+  if (!m_compute_passes.empty()) {
+    const GpuProfiler::Scope compute_scope(m_gpu_profiler, command_buffer,
+                                           "compute");
+    ComputeRecorder recorder(command_buffer);
+    for (const ComputePass &pass : m_compute_passes) {
+      pass(recorder);
+    }
+  }
+
+  if (gpu_culling() && !m_cull_draws.empty()) {
+    const GpuProfiler::Scope cull_scope(m_gpu_profiler, command_buffer,
+                                        "culling");
+    m_culler->record(command_buffer);
+  }
+
+  const std::array<VkClearValue, 2> clear_values{
+      {{{{0.05f, 0.05f, 0.05f, 1.0f}}}, {{{1.0f, 0}}}}};
+
+  const VkRenderPassBeginInfo render_pass_begin{
+      .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+      .pNext = nullptr,
+      .renderPass = m_render_pass,
+      .framebuffer = framebuffer(image_index),
+      .renderArea = {{0, 0}, extent()},
+      .clearValueCount = static_cast<unsigned>(clear_values.size()),
+      .pClearValues = clear_values.data()};
+
+  const bool parallel = !m_recording_slots.empty();
+  const std::size_t pass_scope =
+      m_gpu_profiler.begin_scope(command_buffer, "render pass");
+  vkCmdBeginRenderPass(command_buffer, &render_pass_begin,
+                       parallel ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
+                                : VK_SUBPASS_CONTENTS_INLINE);
+
+  if (parallel) {
+    record_draws_parallel(command_buffer, image_index);
+  } else {
+    set_dynamic_state(command_buffer);
+    const DrawCounters counters = record_draws(
+        command_buffer, {.end_item = m_draw_list.items().size()}, true);
+    m_draw_calls += counters.draw_calls;
+    m_pipeline_binds += counters.pipeline_binds;
+    m_vertex_buffer_binds += counters.vertex_buffer_binds;
+  }
+
+  vkCmdEndRenderPass(command_buffer);
+  m_gpu_profiler.end_scope(command_buffer, pass_scope);
+}
+
+void Renderer::set_dynamic_state(VkCommandBuffer command_buffer) const {
+  // viewport and scissor are dynamic state shared by every pipeline, so they
+  // are set once per command buffer instead of once per draw
+  VkViewport viewport{};
+  viewport.x = 0.0f;
+  viewport.y = 0.0f;
+  viewport.width = static_cast<float>(extent().width);
+  viewport.height = static_cast<float>(extent().height);
+  viewport.minDepth = 0.0f;
+  viewport.maxDepth = 1.0f;
+  vkCmdSetViewport(command_buffer, 0, 1, &viewport);
+
+  VkRect2D scissor{};
+  scissor.offset = {0, 0};
+  scissor.extent = extent();
+  vkCmdSetScissor(command_buffer, 0, 1, &scissor);
+}
+
+Renderer::DrawCounters Renderer::record_draws(VkCommandBuffer command_buffer,
+                                              const DrawRange &range,
+                                              bool profile_draws) {
+  // sorted draws mostly share state with their predecessor, only what
+  // changed is bound; push constants are per material
+  DrawCounters counters;
+  VkPipeline bound_pipeline = VK_NULL_HANDLE;
+  const resources::Material *bound_material = nullptr;
+  VkBuffer bound_vertex_buffer = VK_NULL_HANDLE;
+  VkBuffer bound_index_buffer = VK_NULL_HANDLE;
+  VkPipelineLayout instances_bound_to = VK_NULL_HANDLE;
+  const std::span<const DrawList::Item> items = m_draw_list.items();
+  std::size_t run_index = range.first_run;
+  for (std::size_t i = range.first_item; i < range.end_item;) {
+    const resources::Mesh *mesh = items[i].mesh;
+    const bool instanced = mesh->material()->instanced();
+
+    const std::size_t draw_scope =
+        profile_draws && m_gpu_profiler.per_draw_scopes()
+            ? m_gpu_profiler.begin_scope(command_buffer,
+                                         std::format("draw {}", i))
+            : GpuProfiler::NOT_MEASURED;
+    if (mesh->pipeline() != bound_pipeline) {
+      bound_pipeline = mesh->pipeline();
+      bound_material = nullptr;
+      vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                        bound_pipeline);
+      ++counters.pipeline_binds;
+    }
+    if (mesh->material() != bound_material) {
+      bound_material = mesh->material();
+      bound_material->update_push_constants(command_buffer);
+    }
+
+    if (mesh->vertices().buffer() != bound_vertex_buffer) {
+      bound_vertex_buffer = mesh->vertices().buffer();
+      const VkDeviceSize offset = 0;
+      vkCmdBindVertexBuffers(command_buffer, 0, 1, &bound_vertex_buffer,
+                             &offset);
+      ++counters.vertex_buffer_binds;
+    }
+    if (mesh->indices().buffer() != bound_index_buffer) {
+      bound_index_buffer = mesh->indices().buffer();
+      vkCmdBindIndexBuffer(command_buffer, bound_index_buffer, 0,
+                           VK_INDEX_TYPE_UINT32);
+    }
+
+    if (instanced) {
+      // one instance set serves every run of the frame, layouts with other
+      // push constants need it bound again
+      if (bound_material->pipeline_layout() != instances_bound_to) {
+        instances_bound_to = bound_material->pipeline_layout();
+        vkCmdBindDescriptorSets(command_buffer,
+                                VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                instances_bound_to, 0, 1,
+                                &m_instance_sets[m_current_frame], 0, nullptr);
+      }
+
+      const IndirectRun &run = m_indirect_runs[run_index];
+      counters.draw_calls += record_indirect_draws(command_buffer, run);
+      ++run_index;
+      i += run.item_count;
+    } else {
+      vkCmdDrawIndexed(command_buffer, mesh->indices_size(), 1,
+                       mesh->first_index(), mesh->vertex_offset(), 0);
+      ++counters.draw_calls;
+      ++i;
+    }
+    m_gpu_profiler.end_scope(command_buffer, draw_scope);
+  }
+  return counters;
+}
+
+void Renderer::split_draws(std::size_t chunk_count) {
+  // indirect runs are recorded whole, chunks may only end between them
+  const std::span<const DrawList::Item> items = m_draw_list.items();
+  const std::size_t target = std::max(
+      (items.size() + chunk_count - 1) / chunk_count, MIN_DRAWS_PER_CHUNK);
+  m_draw_ranges.clear();
+  DrawRange range;
+  std::size_t run_index = 0;
+  for (std::size_t i = 0; i < items.size();) {
+    if (items[i].mesh->material()->instanced()) {
+      i += m_indirect_runs[run_index].item_count;
+      ++run_index;
+    } else {
+      ++i;
+    }
+    if (i - range.first_item >= target || i == items.size()) {
+      range.end_item = i;
+      m_draw_ranges.push_back(range);
+      range = {.first_item = i, .end_item = i, .first_run = run_index};
+    }
+  }
+}
+
+void Renderer::record_draws_parallel(VkCommandBuffer command_buffer,
+                                     unsigned image_index) {
+  split_draws(m_recording_slots[m_current_frame].size());
+  if (m_draw_ranges.empty()) {
     return;
-    break;
+  }
 
-  case VK_SUCCESS:
-  case VK_SUBOPTIMAL_KHR:
-    break;
+  const VkCommandBufferInheritanceInfo inheritance{
+      .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+      .pNext = nullptr,
+      .renderPass = m_render_pass,
+      .subpass = 0,
+      .framebuffer = framebuffer(image_index),
+      .occlusionQueryEnable = VK_FALSE,
+      .queryFlags = 0,
+      .pipelineStatistics = 0};
 
-  default:
-    throw exceptions::AcquireWindowExtensionsError{};
+  // every chunk has its own pool, so no two threads ever touch the same one;
+  // the profiler is not thread-safe, draws are not measured individually
+  std::vector<RecordingSlot> &slots = m_recording_slots[m_current_frame];
+  m_chunk_counters.assign(m_draw_ranges.size(), {});
+  const auto record_chunk = [this, &slots, &inheritance](std::size_t chunk) {
+    slots[chunk].secondary.record(
+        [this, chunk](VkCommandBuffer secondary) {
+          set_dynamic_state(secondary);
+          m_chunk_counters[chunk] =
+              record_draws(secondary, m_draw_ranges[chunk], false);
+        },
+        VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT |
+            VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+        &inheritance);
+  };
+
+  if (m_jobs != nullptr) {
+    // the render thread runs chunks too while waiting
+    JobSystem::Counter counter;
+    for (std::size_t chunk = 0; chunk < m_draw_ranges.size(); ++chunk) {
+      m_jobs->submit([&record_chunk, chunk] { record_chunk(chunk); },
+                     &counter);
+    }
+    m_jobs->wait(counter);
+  } else {
+    // the calling thread records the first chunk instead of idling
+    std::vector<std::future<void>> pending;
+    pending.reserve(m_draw_ranges.size() - 1);
+    for (std::size_t chunk = 1; chunk < m_draw_ranges.size(); ++chunk) {
+      pending.push_back(m_recorders->submit(
+          [&record_chunk, chunk] { record_chunk(chunk); }));
+    }
+    // workers reference this frame, all of them finish before anything throws
+    std::exception_ptr error;
+    try {
+      record_chunk(0);
+    } catch (...) {
+      error = std::current_exception();
+    }
+    for (auto &future : pending) {
+      future.wait();
+    }
+    if (error) {
+      std::rethrow_exception(error);
+    }
+    for (auto &future : pending) {
+      future.get();
+    }
+  }
+
+  std::vector<VkCommandBuffer> secondaries;
+  secondaries.reserve(m_draw_ranges.size());
+  for (std::size_t chunk = 0; chunk < m_draw_ranges.size(); ++chunk) {
+    secondaries.push_back(slots[chunk].secondary.buffer());
+    m_draw_calls += m_chunk_counters[chunk].draw_calls;
+    m_pipeline_binds += m_chunk_counters[chunk].pipeline_binds;
+    m_vertex_buffer_binds += m_chunk_counters[chunk].vertex_buffer_binds;
   }
+  vkCmdExecuteCommands(command_buffer,
+                       static_cast<unsigned>(secondaries.size()),
+                       secondaries.data());
+}
 
-  m_render_fences[m_current_frame].reset();
+void Renderer::render_frame() {
+  const CpuScope render_scope("render_frame");
+  {
+    const CpuScope scope("wait frame");
+    limit_queued_frames();
+  }
+  // one frame of slack covers the presentation still reading the last image
+  const std::uint64_t completed_frames = m_frame_timeline.completed_value();
+  m_deletion_queue.collect(completed_frames != 0 ? completed_frames - 1 : 0);
 
-  m_command_buffers[m_current_frame].reset();
+  // offscreen images are owned per frame slot, nothing to acquire
+  auto image_index = static_cast<unsigned>(m_current_frame);
+  if (m_swapchain) {
+    if (!prepare_swapchain()) {
+      return;
+    }
+
+    VkResult acquire_result = VK_SUCCESS;
+    {
+      const CpuScope scope("acquire");
+      acquire_result = vkAcquireNextImageKHR(
+          m_device, m_swapchain->swapchain(),
+          std::numeric_limits<std::uint64_t>::max(),
+          m_swapchain_semaphores[m_current_frame].semaphore(), VK_NULL_HANDLE,
+          &image_index);
+    }
+
+    switch (acquire_result) {
+    case VK_ERROR_OUT_OF_DATE_KHR:
+      recreate_swapchain();
+      return;
+      break;
+
+    case VK_SUBOPTIMAL_KHR:
+      request_swapchain_recreation();
+      break;
+
+    case VK_SUCCESS:
+      break;
+
+    default:
+      throw exceptions::AcquireWindowExtensionsError{};
+    }
+  }
+
+  // the slot's previous frame has completed, nothing recorded from its
+  // pools is pending
+  m_frame_command_pools[m_current_frame].reset();
+  if (!m_recording_slots.empty()) {
+    for (RecordingSlot &slot : m_recording_slots[m_current_frame]) {
+      slot.pool.reset();
+    }
+  }
+
+  // uploads enqueued since the last frame go out in one transfer submit,
+  // the draws wait for it only at the stages consuming the uploaded data
+  {
+    const CpuScope scope("flush uploads");
+    m_uploads.flush();
+  }
+  const auto &uploads = m_uploads.take_frame_dependencies();
+
+  {
+    const CpuScope scope("build draw list");
+    build_draw_list();
+  }
+
+  {
+    const CpuScope scope("record");
+    m_command_buffers[m_current_frame].record(
+        [this, image_index, &uploads](VkCommandBuffer command_buffer) {
+          record_frame(command_buffer, image_index, uploads);
+        });
+  }
+
+  // values of binary semaphores are ignored
+  std::array<VkSemaphore, 2> wait_semaphores{};
+  std::array<VkPipelineStageFlags, 2> wait_stages{};
+  std::array<std::uint64_t, 2> wait_values{};
+  unsigned wait_count = 0;
+  if (m_swapchain) {
+    wait_semaphores[wait_count] =
+        m_swapchain_semaphores[m_current_frame].semaphore();
+    wait_stages[wait_count] = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    ++wait_count;
+  }
+  if (uploads.timeline != VK_NULL_HANDLE) {
+    wait_semaphores[wait_count] = uploads.timeline;
+    wait_stages[wait_count] = uploads.wait_stages;
+    wait_values[wait_count] = uploads.value;
+    ++wait_count;
+  }
 
-  const VkSemaphore wait_semaphores[] = {
-      m_swapchain_semaphores[m_current_frame].semaphore()};
   const VkCommandBuffer command_buffers[] = {
       m_command_buffers[m_current_frame].buffer()};
-  const VkSemaphore signal_semaphores[] = {
+  // only presentation waits on the render semaphore
+  std::array<VkSemaphore, 2> signal_semaphores{m_frame_timeline.semaphore()};
+  std::array<std::uint64_t, 2> signal_values{m_frame_timeline.next_value()};
+  unsigned signal_count = 1;
+  if (m_swapchain) {
+    signal_semaphores[signal_count] =
+        m_render_semaphores[m_current_frame].semaphore();
+    ++signal_count;
+  }
+  const VkTimelineSemaphoreSubmitInfo timeline_info{
+      .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+      .pNext = nullptr,
+      .waitSemaphoreValueCount = wait_count,
+      .pWaitSemaphoreValues = wait_values.data(),
+      .signalSemaphoreValueCount = signal_count,
+      .pSignalSemaphoreValues = signal_values.data()};
+
+  const VkSubmitInfo submit_info{
+      .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+      .pNext = &timeline_info,
+      .waitSemaphoreCount = wait_count,
+      .pWaitSemaphores = wait_semaphores.data(),
+      .pWaitDstStageMask = wait_stages.data(),
+      .commandBufferCount = 1,
+      .pCommandBuffers = command_buffers,
+      .signalSemaphoreCount = signal_count,
+      .pSignalSemaphores = signal_semaphores.data()};
+  {
+    const CpuScope scope("submit");
+    m_graphics_queue.submit(submit_info, VK_NULL_HANDLE);
+  }
+  ++m_graphics_submits;
+  ++m_frame_count;
+
+  if (m_swapchain) {
+    present(image_index);
+  }
+
+  ++m_current_frame;
+  m_current_frame %= frames_in_flight();
+  /*std::exit(0);*/
+}
+
+void Renderer::make_frame_resources(std::size_t count) {
+  // destroying the pools frees their buffers
+  m_command_buffers.clear();
+  m_frame_command_pools.clear();
+  for (std::size_t i = 0; i < count; ++i) {
+    m_frame_command_pools.emplace_back(m_device, m_physical_device, m_surface,
+                                       false,
+                                       VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+    m_command_buffers.push_back(
+        m_frame_command_pools.back().make_command_buffers(1).front());
+  }
+
+  m_swapchain_semaphores.resize(count);
+  m_render_semaphores.resize(count);
+  m_instance_buffers.resize(count);
+  m_indirect_buffers.resize(count);
+  m_identity_buffers.resize(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    m_swapchain_semaphores[i] = Semaphore(m_device);
+    m_render_semaphores[i] = Semaphore(m_device);
+  }
+  m_current_frame = 0;
+  m_max_queued_frames = std::min(m_max_queued_frames, count);
+  make_recording_slots();
+}
+
+void Renderer::make_recording_slots() {
+  m_recording_slots.clear();
+  if (m_recording_threads == 1) {
+    return;
+  }
+  m_recording_slots.resize(frames_in_flight());
+  for (auto &slots : m_recording_slots) {
+    slots.reserve(m_recording_threads);
+    for (std::size_t i = 0; i < m_recording_threads; ++i) {
+      CommandPool pool(m_device, m_physical_device, m_surface, false,
+                       VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+      const CommandBuffer secondary =
+          pool.make_command_buffers(1, VK_COMMAND_BUFFER_LEVEL_SECONDARY)
+              .front();
+      slots.push_back({.pool = std::move(pool), .secondary = secondary});
+    }
+  }
+}
+
+void Renderer::set_recording_threads(std::size_t threads) {
+  threads = std::clamp<std::size_t>(threads, 1, MAX_RECORDING_THREADS);
+  if (threads == m_recording_threads) {
+    return;
+  }
+  // a rare settings change, the simple full drain is fine here
+  vkDeviceWaitIdle(m_device);
+  m_recording_threads = threads;
+  make_recorders();
+  make_recording_slots();
+}
+
+void Renderer::set_job_system(JobSystem *jobs) {
+  m_jobs = jobs;
+  make_recorders();
+}
+
+void Renderer::make_recorders() {
+  m_recorders.reset();
+  // a job system takes the chunks instead
+  if (m_recording_threads > 1 && m_jobs == nullptr) {
+    m_recorders.emplace(m_recording_threads - 1);
+  }
+}
+
+void Renderer::set_frames_in_flight(std::size_t count) {
+  count = std::clamp<std::size_t>(count, 1, MAX_FRAMES_IN_FLIGHT);
+  if (count == frames_in_flight()) {
+    return;
+  }
+  // a rare settings change, the simple full drain is fine here
+  vkDeviceWaitIdle(m_device);
+  m_deletion_queue.flush();
+  const bool limited = m_max_queued_frames < frames_in_flight();
+  make_frame_resources(count);
+  if (!limited) {
+    m_max_queued_frames = count;
+  }
+}
+
+void Renderer::set_max_queued_frames(std::size_t count) {
+  m_max_queued_frames = std::clamp<std::size_t>(count, 1, frames_in_flight());
+}
+
+void Renderer::limit_queued_frames() {
+  // frame `m_frame_count - m_max_queued_frames` is the newest one that has
+  // to be done; it is no older than the current slot's previous frame
+  if (m_frame_count >= m_max_queued_frames) {
+    m_frame_timeline.wait(m_frame_count - m_max_queued_frames + 1);
+  }
+}
+
+bool Renderer::prepare_swapchain() {
+  const VkExtent2D window_extent{static_cast<unsigned>(m_window->width),
+                                 static_cast<unsigned>(m_window->height)};
+  if (window_extent.width != m_window_extent.width ||
+      window_extent.height != m_window_extent.height) {
+    m_window_extent = window_extent;
+    m_swapchain_dirty = true;
+    m_resize_requested_at = std::chrono::steady_clock::now();
+  }
+
+  if (m_swapchain_dirty &&
+      std::chrono::steady_clock::now() - m_resize_requested_at >=
+          m_resize_policy.settle_time) {
+    recreate_swapchain();
+  }
+  return window_extent.width != 0 && window_extent.height != 0;
+}
+
+void Renderer::request_swapchain_recreation() {
+  if (m_resize_policy.recreate_when_suboptimal && !m_swapchain_dirty) {
+    m_swapchain_dirty = true;
+    m_resize_requested_at = std::chrono::steady_clock::now();
+  }
+}
+
+void Renderer::recreate_swapchain() {
+  // a minimized window has no extent to create a swapchain with
+  if (m_window->width == 0 || m_window->height == 0) {
+    m_swapchain_dirty = true;
+    return;
+  }
+
+  const CpuScope scope("recreate swapchain");
+  Swapchain swapchain(m_device, m_physical_device, m_surface, *m_window,
+                      m_present_policy, m_render_pass,
+                      m_swapchain->swapchain());
+  retire(std::move(*m_swapchain));
+  *m_swapchain = std::move(swapchain);
+  m_swapchain_dirty = false;
+}
+
+void Renderer::submit_instanced(
+    const resources::Mesh *mesh,
+    std::span<const resources::InstanceData> instances) {
+  assert(mesh->material()->instanced());
+  m_instanced_draws.push_back({.mesh = mesh, .instances = instances});
+}
+
+void Renderer::remove_mesh(const resources::Mesh *mesh) {
+  std::erase(m_meshes, mesh);
+  std::erase_if(m_instanced_draws, [mesh](const InstancedDraw &draw) {
+    return draw.mesh == mesh;
+  });
+}
+
+void Renderer::grow_frame_buffer(Buffer &buffer, VkDeviceSize size,
+                                 VkBufferUsageFlags usage) {
+  if (buffer.size() < size) {
+    buffer = Buffer(*this, std::max(size, 2 * buffer.size()), usage);
+    buffer.allocate(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                    VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+  }
+}
+
+std::size_t Renderer::record_indirect_draws(VkCommandBuffer command_buffer,
+                                            const IndirectRun &run) const {
+  constexpr auto stride =
+      static_cast<unsigned>(sizeof(VkDrawIndexedIndirectCommand));
+  // culled commands are at the same index as their templates
+  const VkBuffer buffer = gpu_culling()
+                              ? m_culler->commands()
+                              : m_indirect_buffers[m_current_frame].buffer();
+  if (m_multi_draw_indirect) {
+    vkCmdDrawIndexedIndirect(command_buffer, buffer,
+                             run.first_command * stride,
+                             static_cast<unsigned>(run.command_count), stride);
+    return 1;
+  }
+  // without multiDrawIndirect the draw count must be 0 or 1
+  for (std::size_t i = 0; i < run.command_count; ++i) {
+    vkCmdDrawIndexedIndirect(command_buffer, buffer,
+                             (run.first_command + i) * stride, 1, stride);
+  }
+  return run.command_count;
+}
+
+void Renderer::build_draw_list() {
+  m_draw_list.clear();
+  for (const resources::Mesh *mesh : m_meshes) {
+    if (mesh->material()->ready()) {
+      m_draw_list.add(mesh, 0, mesh->sort_depth());
+    }
+  }
+
+  std::size_t instance_count = 0;
+  for (const InstancedDraw &draw : m_instanced_draws) {
+    instance_count += draw.instances.size();
+  }
+
+  // the slot's previous frame has completed, so its buffers are free to
+  // overwrite or replace
+  Buffer &instances = m_instance_buffers[m_current_frame];
+  if (instance_count != 0) {
+    grow_frame_buffer(instances,
+                      instance_count * sizeof(resources::InstanceData),
+                      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+
+    std::byte *destination = instances.mapped();
+    unsigned first_instance = 0;
+    for (const InstancedDraw &draw : m_instanced_draws) {
+      const auto source = std::as_bytes(draw.instances);
+      std::memcpy(destination, source.data(), source.size());
+      destination += source.size();
+
+      const auto count = static_cast<unsigned>(draw.instances.size());
+      if (count != 0 && draw.mesh->material()->ready()) {
+        m_draw_list.add(draw.mesh, 0, draw.mesh->sort_depth(), first_instance,
+                        count);
+      }
+      first_instance += count;
+    }
+  }
+  m_draw_list.sort();
+
+  // consecutive instanced draws of one material form a single indirect run;
+  // meshes share the arena pages, so different meshes batch together and
+  // only a page change, which needs a rebind, splits a run. Every item is
+  // one command; with culling it is a template the GPU counts the surviving
+  // instances into
+  const bool culling = gpu_culling();
+  const std::span<const DrawList::Item> items = m_draw_list.items();
+  m_indirect_runs.clear();
+  m_cull_draws.clear();
+  std::size_t command_count = 0;
+  for (std::size_t i = 0; i < items.size();) {
+    const resources::Mesh *mesh = items[i].mesh;
+    if (!mesh->material()->instanced()) {
+      ++i;
+      continue;
+    }
+
+    IndirectRun run{.first_item = i, .first_command = command_count};
+    for (; i < items.size() && items[i].mesh->material() == mesh->material() &&
+           items[i].mesh->vertices().buffer() == mesh->vertices().buffer() &&
+           items[i].mesh->indices().buffer() == mesh->indices().buffer();
+         ++i) {
+      if (culling) {
+        m_cull_draws.push_back(
+            {.bounding_sphere = items[i].mesh->bounding_sphere(),
+             .first_instance = items[i].first_instance,
+             .instance_count = items[i].instance_count});
+      }
+      ++run.item_count;
+    }
+    run.command_count = run.item_count;
+    command_count += run.command_count;
+    m_indirect_runs.push_back(run);
+  }
+
+  if (command_count == 0) {
+    return;
+  }
+  Buffer &templates = m_indirect_buffers[m_current_frame];
+  grow_frame_buffer(templates,
+                    command_count * sizeof(VkDrawIndexedIndirectCommand),
+                    VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                        VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+  auto *commands =
+      reinterpret_cast<VkDrawIndexedIndirectCommand *>(templates.mapped());
+  for (const IndirectRun &run : m_indirect_runs) {
+    for (std::size_t i = 0; i < run.item_count; ++i) {
+      const DrawList::Item &item = items[run.first_item + i];
+      commands[run.first_command + i] = {
+          .indexCount = static_cast<unsigned>(item.mesh->indices_size()),
+          .instanceCount = culling ? 0 : item.instance_count,
+          .firstIndex = item.mesh->first_index(),
+          .vertexOffset = item.mesh->vertex_offset(),
+          .firstInstance = item.first_instance};
+    }
+  }
+
+  if (culling) {
+    m_culler->begin_frame(m_current_frame, instances.buffer(), instance_count,
+                          templates.buffer(), m_cull_draws);
+    update_instance_set(m_culler->visible());
+    return;
+  }
+
+  // without culling instances are read through an identity mapping, which
+  // only has to be written when its buffer is replaced
+  Buffer &identity = m_identity_buffers[m_current_frame];
+  if (identity.size() < instance_count * sizeof(unsigned)) {
+    grow_frame_buffer(identity, instance_count * sizeof(unsigned),
+                      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    auto *indices = reinterpret_cast<unsigned *>(identity.mapped());
+    std::iota(indices, indices + identity.size() / sizeof(unsigned), 0u);
+  }
+  update_instance_set(identity.buffer());
+}
+
+void Renderer::make_instance_sets() {
+  m_instance_set_layout =
+      m_instance_set_layout_maker
+          .add_binding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                       VK_SHADER_STAGE_VERTEX_BIT)
+          .add_binding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                       VK_SHADER_STAGE_VERTEX_BIT)
+          .make_descriptor_set_layout();
+
+  const auto set_count = static_cast<unsigned>(MAX_FRAMES_IN_FLIGHT);
+  const VkDescriptorPoolSize pool_size{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                                       2 * set_count};
+  const VkDescriptorPoolCreateInfo pool_info{
+      .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = 0,
+      .maxSets = set_count,
+      .poolSizeCount = 1,
+      .pPoolSizes = &pool_size};
+  VkDescriptorPool pool = VK_NULL_HANDLE;
+  if (vkCreateDescriptorPool(m_device, &pool_info, nullptr, &pool) !=
+      VK_SUCCESS) {
+    throw exceptions::DescriptorPoolCreationError{};
+  }
+  m_instance_descriptor_pool = {pool, m_device};
+
+  const std::vector<VkDescriptorSetLayout> set_layouts(
+      set_count, m_instance_set_layout);
+  m_instance_sets.resize(set_count);
+  const VkDescriptorSetAllocateInfo allocate_info{
+      .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+      .pNext = nullptr,
+      .descriptorPool = pool,
+      .descriptorSetCount = set_count,
+      .pSetLayouts = set_layouts.data()};
+  if (vkAllocateDescriptorSets(m_device, &allocate_info,
+                               m_instance_sets.data()) != VK_SUCCESS) {
+    throw exceptions::DescriptorSetAllocationError{};
+  }
+}
+
+void Renderer::update_instance_set(VkBuffer indices) {
+  // the slot's previous frame has completed, its set is no longer in use
+  const std::array<VkDescriptorBufferInfo, 2> buffer_infos = {
+      {{m_instance_buffers[m_current_frame].buffer(), 0, VK_WHOLE_SIZE},
+       {indices, 0, VK_WHOLE_SIZE}}};
+  std::array<VkWriteDescriptorSet, 2> writes{};
+  for (unsigned i = 0; i < writes.size(); ++i) {
+    writes[i] = {.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                 .pNext = nullptr,
+                 .dstSet = m_instance_sets[m_current_frame],
+                 .dstBinding = i,
+                 .dstArrayElement = 0,
+                 .descriptorCount = 1,
+                 .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                 .pImageInfo = nullptr,
+                 .pBufferInfo = &buffer_infos[i],
+                 .pTexelBufferView = nullptr};
+  }
+  vkUpdateDescriptorSets(m_device, static_cast<unsigned>(writes.size()),
+                         writes.data(), 0, nullptr);
+}
+
+bool Renderer::set_gpu_culling(bool enabled) {
+  if (enabled && !m_culler) {
+    return false;
+  }
+  m_gpu_culling = enabled;
+  return true;
+}
+
+void Renderer::set_cull_view_projection(const glm::mat4 &view_projection) {
+  if (m_culler) {
+    m_culler->set_view_projection(view_projection);
+  }
+}
+
+void Renderer::set_present_policy(const PresentPolicy &policy) {
+  m_present_policy = policy;
+  if (m_swapchain) {
+    recreate_swapchain();
+  }
+}
+
+void Renderer::present(unsigned image_index) {
+  const VkSemaphore wait_semaphores[] = {
       m_render_semaphores[m_current_frame].semaphore()};
-  const VkPipelineStageFlags wait_stages[] = {
-      VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-
-  for (const auto mesh : m_meshes) {
-    auto draw_mesh_commands = [this, image_index,
-                               mesh](VkCommandBuffer command_buffer) {
-      const std::array<VkClearValue, 2> clear_values{
-          {{{{0.05f, 0.05f, 0.05f, 1.0f}}}, {{{1.0f, 0}}}}};
-
-      const VkRenderPassBeginInfo render_pass_begin{
-          .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
-          .pNext = nullptr,
-          .renderPass = m_render_pass,
-          .framebuffer = m_swapchain.framebuffers()[image_index],
-          .renderArea = {{0, 0}, m_swapchain.extent()},
-          .clearValueCount = static_cast<unsigned>(clear_values.size()),
-          .pClearValues = clear_values.data()};
-
-      vkCmdBeginRenderPass(command_buffer, &render_pass_begin,
-                           VK_SUBPASS_CONTENTS_INLINE);
-      vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                        mesh->pipeline());
-      mesh->material()->update_push_constants(command_buffer);
-
-      VkViewport viewport{};
-      viewport.x = 0.0f;
-      viewport.y = 0.0f;
-      viewport.width = static_cast<float>(m_swapchain.extent().width);
-      viewport.height = static_cast<float>(m_swapchain.extent().height);
-      viewport.minDepth = 0.0f;
-      viewport.maxDepth = 1.0f;
-      vkCmdSetViewport(command_buffer, 0, 1, &viewport);
-
-      VkRect2D scissor{};
-      scissor.offset = {0, 0};
-      scissor.extent = m_swapchain.extent();
-      vkCmdSetScissor(command_buffer, 0, 1, &scissor);
-
-      VkBuffer vertex_buffers[] = {mesh->vertices().buffer()};
-      VkDeviceSize offsets[] = {0};
-      vkCmdBindVertexBuffers(command_buffer, 0, 1, vertex_buffers, offsets);
-      vkCmdBindIndexBuffer(command_buffer, mesh->indices().buffer(), 0,
-                           VK_INDEX_TYPE_UINT32);
-      vkCmdDrawIndexed(command_buffer, mesh->indices_size(), 1, 0, 0, 0);
-
-      vkCmdEndRenderPass(command_buffer);
-    };
-    m_command_buffers[m_current_frame].record(draw_mesh_commands);
-
-    const VkSubmitInfo submit_info{.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-                                   .pNext = nullptr,
-                                   .waitSemaphoreCount = 1,
-                                   .pWaitSemaphores = wait_semaphores,
-                                   .pWaitDstStageMask = wait_stages,
-                                   .commandBufferCount = 1,
-                                   .pCommandBuffers = command_buffers,
-                                   .signalSemaphoreCount = 1,
-                                   .pSignalSemaphores = signal_semaphores};
-    m_graphics_queue.submit(submit_info,
-                            m_render_fences[m_current_frame].fence());
-  }
-
-  VkSwapchainKHR swapchain_ptr[] = {m_swapchain.swapchain()};
+  VkSwapchainKHR swapchain_ptr[] = {m_swapchain->swapchain()};
   const VkPresentInfoKHR present_info{
       .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
       .pNext = nullptr,
       .waitSemaphoreCount = 1,
-      .pWaitSemaphores = signal_semaphores,
+      .pWaitSemaphores = wait_semaphores,
       .swapchainCount = 1,
       .pSwapchains = swapchain_ptr,
       .pImageIndices = &image_index,
       .pResults = nullptr,
   };
 
-  const VkResult present_result =
-      vkQueuePresentKHR(m_present_queue.queue(), &present_info);
+  VkResult present_result = VK_SUCCESS;
+  {
+    const CpuScope scope("present");
+    present_result = vkQueuePresentKHR(m_present_queue.queue(), &present_info);
+  }
 
   switch (present_result) {
   case VK_ERROR_OUT_OF_DATE_KHR:
+    recreate_swapchain();
+    break;
+
   case VK_SUBOPTIMAL_KHR:
-    vkDeviceWaitIdle(m_device);
-    m_swapchain = Swapchain(m_device, m_physical_device, m_surface, m_window,
-                            m_render_pass);
+    request_swapchain_recreation();
+    break;
 
   case VK_SUCCESS:
     break;
@@ -494,10 +1261,16 @@ void Renderer::render_frame() {
   default:
     throw exceptions::PresentSwapchainError{};
   }
+}
 
-  ++m_current_frame;
-  m_current_frame %= FRAME_OVERLAP;
-  /*std::exit(0);*/
+Renderer::Stats Renderer::stats() const {
+  return {.frames = m_frame_count,
+          .draw_calls = m_draw_calls,
+          .pipeline_binds = m_pipeline_binds,
+          .vertex_buffer_binds = m_vertex_buffer_binds,
+          .graphics_submits = m_graphics_submits,
+          .transfer_submits =
+              static_cast<std::size_t>(m_staging_ring.submitted_count())};
 }
 
 } // namespace engine::core
@@ -1,14 +1,36 @@
 #pragma once
 
+#include "buffer_arena.hpp"       // for BufferArena
 #include "command_buffers.hpp"    // for CommandPool, CommandBuffer
+#include "compute_pipeline.hpp"   // for ComputeRecorder, DescriptorSetLay...
+#include "deletion_queue.hpp"     // for DeletionQueue
+#include "draw_list.hpp"          // for DrawList
+#include "glm/mat4x4.hpp"
+#include "gpu_culling.hpp"        // for GpuCuller
+#include "gpu_profiler.hpp"       // for GpuProfiler
+#include "job_system.hpp"         // for JobSystem
+#include "memory_allocator.hpp"   // for MemoryAllocator
 #include "mesh.hpp"               // for Mesh
+#include "offscreen_target.hpp"   // for OffscreenTarget
+#include "pipeline_cache.hpp"     // for PipelineCache
+#include "pipeline_registry.hpp"  // for PipelineRegistry
 #include "queue.hpp"              // for CommandQueue, CommandQueue::Kind::...
-#include "swapchain.hpp"          // for Swapchain, Window
-#include "synchronization.hpp"    // for Semaphore, Fence
+#include "shader_cache.hpp"       // for ShaderCache
+#include "staging_ring.hpp"       // for StagingRing
+#include "swapchain.hpp"          // for Swapchain, PresentPolicy, Window
+#include "synchronization.hpp"    // for Semaphore, TimelineSemaphore
+#include "thread_pool.hpp"        // for ThreadPool
+#include "upload_scheduler.hpp"   // for UploadScheduler
+#include "vulkan_buffers.hpp"     // for Buffer
 #include "vulkan_destroyable.hpp" // for VkDestroyable, VkDebugUtilsMesseng...
-#include <array>                  // for array
+#include <cassert>                // for assert
+#include <chrono>                 // for milliseconds, steady_clock
 #include <cstddef>                // for size_t
-#include <utility>                // for unreachable
+#include <functional>             // for function
+#include <optional>               // for optional
+#include <span>                   // for span
+#include <type_traits>            // for is_lvalue_reference_v
+#include <utility>                // for unreachable, move
 #include <vector>                 // for vector
 #include <vulkan/vulkan_core.h>   // for VkDevice, VkPhysicalDevice, vkDevi...
 
@@ -16,7 +38,27 @@ namespace engine::core {
 
 class Renderer {
 public:
-  Renderer(Window &window);
+  struct Stats {
+    std::size_t frames = 0;
+    std::size_t draw_calls = 0;
+    std::size_t pipeline_binds = 0;
+    std::size_t vertex_buffer_binds = 0;
+    std::size_t graphics_submits = 0;
+    std::size_t transfer_submits = 0;
+  };
+
+  // when a window resize or VK_SUBOPTIMAL_KHR asks for a new swapchain, it is
+  // rebuilt only once the window size has not changed for `settle_time`;
+  // VK_ERROR_OUT_OF_DATE_KHR always rebuilds right away
+  struct ResizePolicy {
+    std::chrono::milliseconds settle_time{100};
+    bool recreate_when_suboptimal = true;
+  };
+
+  Renderer(Window &window, const PresentPolicy &present_policy = {});
+
+  // renders into offscreen images, no window, surface or swapchain involved
+  explicit Renderer(VkExtent2D offscreen_extent);
 
   void render_frame();
 
@@ -28,14 +70,28 @@ public:
     return m_physical_device;
   }
 
-  [[nodiscard]] const CommandPool &command_pool() const {
-    return m_command_pool;
+  [[nodiscard]] MemoryAllocator &allocator() { return m_allocator; }
+
+  [[nodiscard]] const MemoryAllocator &allocator() const {
+    return m_allocator;
   }
 
+  [[nodiscard]] StagingRing &staging_ring() { return m_staging_ring; }
+
+  [[nodiscard]] UploadScheduler &uploads() { return m_uploads; }
+
+  // shared by every mesh, see `BufferArena`
+  [[nodiscard]] BufferArena &vertex_arena() { return m_vertex_arena; }
+  [[nodiscard]] BufferArena &index_arena() { return m_index_arena; }
+
   [[nodiscard]] const CommandPool &transfer_command_pool() const {
     return m_transfer_command_pool;
   }
 
+  [[nodiscard]] CommandPool &transfer_command_pool() {
+    return m_transfer_command_pool;
+  }
+
   [[nodiscard]] CommandQueue &queue(CommandQueue::Kind kind) {
     using enum CommandQueue::Kind;
     switch (kind) {
@@ -52,10 +108,105 @@ public:
 
   [[nodiscard]] VkRenderPass render_pass() const { return m_render_pass; }
 
-  [[nodiscard]] const Swapchain &swapchain() const { return m_swapchain; }
+  [[nodiscard]] const PipelineCache &pipeline_cache() const {
+    return m_pipeline_cache;
+  }
+
+  [[nodiscard]] ShaderCache &shaders() { return m_shaders; }
+
+  [[nodiscard]] PipelineRegistry &pipelines() { return m_pipelines; }
+
+  [[nodiscard]] ThreadPool &workers() { return m_workers; }
+
+  [[nodiscard]] bool headless() const { return !m_swapchain.has_value(); }
+
+  [[nodiscard]] const Swapchain &swapchain() const {
+    assert(m_swapchain);
+    return *m_swapchain;
+  }
+
+  // format and extent of whatever is rendered into
+  [[nodiscard]] VkFormat color_format() const {
+    return m_swapchain ? m_swapchain->image_format()
+                       : m_offscreen->image_format();
+  }
+
+  [[nodiscard]] VkExtent2D extent() const {
+    return m_swapchain ? m_swapchain->extent() : m_offscreen->extent();
+  }
+
+  // counters since construction
+  [[nodiscard]] Stats stats() const;
+
+  void set_resize_policy(const ResizePolicy &policy) {
+    m_resize_policy = policy;
+  }
+  [[nodiscard]] const ResizePolicy &resize_policy() const {
+    return m_resize_policy;
+  }
+
+  // swaps the swapchain for one following `policy` without draining the
+  // device; stored only when headless. swapchain().present_mode() and
+  // swapchain().image_count() report what the surface allowed
+  void set_present_policy(const PresentPolicy &policy);
+  [[nodiscard]] const PresentPolicy &present_policy() const {
+    return m_present_policy;
+  }
+
+  [[nodiscard]] GpuProfiler &gpu_profiler() { return m_gpu_profiler; }
+
+  [[nodiscard]] const GpuProfiler &gpu_profiler() const {
+    return m_gpu_profiler;
+  }
 
   void submit_mesh(const resources::Mesh *mesh) { m_meshes.emplace_back(mesh); }
 
+  // stops drawing `mesh`, whether submitted plainly or instanced; frames
+  // already recorded still use it, hand it over to `retire`
+  void remove_mesh(const resources::Mesh *mesh);
+
+  // takes ownership of `object` and destroys it once every frame recorded so
+  // far has finished, so buffers, meshes, materials, pipelines or views can
+  // be replaced mid-session without draining the device
+  template <typename T>
+    requires(!std::is_lvalue_reference_v<T>)
+  void retire(T &&object) {
+    m_deletion_queue.push(std::move(object), m_frame_count);
+  }
+
+  // draws `mesh` once per element of `instances` with a single call. The
+  // span is copied into a per-frame instance buffer every frame, so it may be
+  // updated in place but must stay valid; the mesh needs an instanced material
+  void submit_instanced(const resources::Mesh *mesh,
+                        std::span<const resources::InstanceData> instances);
+
+  // set 0 of instanced materials: InstanceData as `mat4 transforms[]` at
+  // binding 0 and, at binding 1, the index of the InstanceData drawn as each
+  // gl_InstanceIndex. Bound by the renderer, materials only put it in their
+  // pipeline layout
+  [[nodiscard]] VkDescriptorSetLayout instance_set_layout() const {
+    return m_instance_set_layout;
+  }
+  [[nodiscard]] std::span<const VkDescriptorSetLayoutBinding>
+  instance_set_bindings() const {
+    return m_instance_set_layout_maker.bindings();
+  }
+
+  // frustum culls instanced draws in a compute pass before rendering; returns
+  // false if the device lacks multiDrawIndirect
+  bool set_gpu_culling(bool enabled);
+  [[nodiscard]] bool gpu_culling() const { return m_gpu_culling; }
+
+  // should match the view-projection the instanced materials render with
+  void set_cull_view_projection(const glm::mat4 &view_projection);
+
+  // recorded every frame outside of the render pass, before any draw; the
+  // pass issues `ComputeRecorder::barrier` for whatever consumes its results
+  using ComputePass = std::function<void(ComputeRecorder &)>;
+  void submit_compute(ComputePass pass) {
+    m_compute_passes.push_back(std::move(pass));
+  }
+
   Renderer(const Renderer &) = delete;
   Renderer(Renderer &&) noexcept = delete;
   Renderer &operator=(const Renderer &) = delete;
@@ -63,11 +214,55 @@ public:
 
   ~Renderer() = default;
 
-  static constexpr std::size_t FRAME_OVERLAP = 2;
+  static constexpr std::size_t MAX_FRAMES_IN_FLIGHT = 4;
+  static constexpr std::size_t DEFAULT_FRAMES_IN_FLIGHT = 2;
+
+  // number of frames with their own command buffer and semaphores, clamped
+  // to [1, MAX_FRAMES_IN_FLIGHT]; changing it waits for the device
+  void set_frames_in_flight(std::size_t count);
+  [[nodiscard]] std::size_t frames_in_flight() const {
+    return m_command_buffers.size();
+  }
+
+  // how many submitted frames the CPU may run ahead of the GPU, clamped to
+  // [1, frames_in_flight()]; 1 trades throughput for input latency
+  void set_max_queued_frames(std::size_t count);
+  [[nodiscard]] std::size_t max_queued_frames() const {
+    return m_max_queued_frames;
+  }
+
+  static constexpr std::size_t MAX_RECORDING_THREADS = 16;
+
+  // splits the draw list into up to `threads` chunks recorded in parallel
+  // into secondary command buffers, each chunk with its own pool per frame
+  // in flight; 1 records inline on the render thread. Waits for the device
+  void set_recording_threads(std::size_t threads);
+  [[nodiscard]] std::size_t recording_threads() const {
+    return m_recording_threads;
+  }
+
+  // parallel recording submits its chunks to `jobs` instead of to threads of
+  // its own; `jobs` must outlive the renderer, null goes back to own threads
+  void set_job_system(JobSystem *jobs);
+
+  // frames are numbered from 0 in submission order; polling never blocks.
+  // Frame `n` signals value `n + 1` of `frame_timeline()`, which other
+  // submits may wait on directly
+  [[nodiscard]] bool frame_complete(std::size_t frame) const {
+    return m_frame_timeline.reached(frame + 1);
+  }
+  [[nodiscard]] VkSemaphore frame_timeline() const {
+    return m_frame_timeline.semaphore();
+  }
 
 private:
   std::size_t m_current_frame;
-  Window &m_window;
+  Window *m_window = nullptr; // null when headless
+  std::size_t m_frame_count = 0;
+  std::size_t m_draw_calls = 0;
+  std::size_t m_pipeline_binds = 0;
+  std::size_t m_vertex_buffer_binds = 0;
+  std::size_t m_graphics_submits = 0;
 
   VkDestroyable<VkInstance> m_instance;
   VkDestroyable<VkDebugUtilsMessengerEXTWrapper> m_debug_messenger;
@@ -77,26 +272,188 @@ private:
   VkPhysicalDevice m_physical_device;
   VkDestroyable<VkDevice> m_device;
 
+  MemoryAllocator m_allocator;
+  PipelineCache m_pipeline_cache;
+  ShaderCache m_shaders;
+  PipelineRegistry m_pipelines;
+
   CommandQueue m_graphics_queue;
   CommandQueue m_present_queue;
   CommandQueue m_transfer_queue;
 
-  Swapchain m_swapchain;
+  GpuProfiler m_gpu_profiler;
+
+  // exactly one of them is engaged
+  std::optional<Swapchain> m_swapchain;
+  std::optional<OffscreenTarget> m_offscreen;
+
+  ResizePolicy m_resize_policy;
+  PresentPolicy m_present_policy;
+  bool m_swapchain_dirty = false;
+  std::chrono::steady_clock::time_point m_resize_requested_at;
+  VkExtent2D m_window_extent{};
 
   VkDestroyable<VkRenderPassWrapper> m_render_pass;
   /*VkDestroyable<VkPipelineLayoutWrapper> m_pipeline_layout;*/
   /*VkDestroyable<VkPipelineWrapper> m_pipeline;*/
 
-  CommandPool m_command_pool;
   CommandPool m_transfer_command_pool;
-  std::array<CommandBuffer, FRAME_OVERLAP> m_command_buffers;
-
-  std::array<Fence, FRAME_OVERLAP> m_render_fences;
-  std::array<Semaphore, FRAME_OVERLAP> m_swapchain_semaphores;
-  std::array<Semaphore, FRAME_OVERLAP> m_render_semaphores;
+  StagingRing m_staging_ring;
+  UploadScheduler m_uploads;
+  BufferArena m_vertex_arena;
+  BufferArena m_index_arena;
+  // graphics submits, compute included, signal the number of frames done
+  TimelineSemaphore m_frame_timeline;
+  // one element per frame in flight; the binary semaphores are for the
+  // swapchain, which does not take timeline semaphores. Frame pools are
+  // transient and reset as a whole once their slot's frame has completed
+  std::vector<CommandPool> m_frame_command_pools;
+  std::vector<CommandBuffer> m_command_buffers;
+  std::vector<Semaphore> m_swapchain_semaphores;
+  std::vector<Semaphore> m_render_semaphores;
+  // host visible, grown on demand; written only after the slot's last frame
+  // has completed
+  std::vector<Buffer> m_instance_buffers;
+  std::vector<Buffer> m_indirect_buffers;
+  std::vector<Buffer> m_identity_buffers; // 0, 1, 2... read when not culling
+  // one instance set per frame slot, rewritten every frame
+  DescriptorSetLayoutMaker m_instance_set_layout_maker;
+  VkDestroyable<VkDescriptorSetLayoutWrapper> m_instance_set_layout;
+  VkDestroyable<VkDescriptorPoolWrapper> m_instance_descriptor_pool;
+  std::vector<VkDescriptorSet> m_instance_sets;
+  bool m_multi_draw_indirect = false; // drawCount > 1 is supported
+  std::optional<GpuCuller> m_culler;  // only with multiDrawIndirect
+  bool m_gpu_culling = false;
+  std::size_t m_max_queued_frames = DEFAULT_FRAMES_IN_FLIGHT;
 
   /*std::vector<std::unique_ptr<RenderObject>> m_render_objects;*/
   std::vector<const resources::Mesh *> m_meshes;
+  DrawList m_draw_list; // rebuilt from `m_meshes` every frame
+
+  struct InstancedDraw {
+    const resources::Mesh *mesh = nullptr;
+    std::span<const resources::InstanceData> instances;
+  };
+  std::vector<InstancedDraw> m_instanced_draws;
+
+  // consecutive draw list items drawn by one indirect call
+  struct IndirectRun {
+    std::size_t first_item = 0;
+    std::size_t item_count = 0;
+    std::size_t first_command = 0;
+    std::size_t command_count = 0;
+  };
+  std::vector<IndirectRun> m_indirect_runs;
+  std::vector<GpuCuller::Draw> m_cull_draws;
+
+  // chunks smaller than this are not worth a thread
+  static constexpr std::size_t MIN_DRAWS_PER_CHUNK = 64;
+
+  struct DrawRange {
+    std::size_t first_item = 0;
+    std::size_t end_item = 0;
+    std::size_t first_run = 0; // index of the first indirect run in range
+  };
+
+  struct DrawCounters {
+    std::size_t draw_calls = 0;
+    std::size_t pipeline_binds = 0;
+    std::size_t vertex_buffer_binds = 0;
+  };
+
+  // recorded by one thread at a time, so the pool needs no locking; reset
+  // together with the frame pool
+  struct RecordingSlot {
+    CommandPool pool;
+    CommandBuffer secondary;
+  };
+  std::size_t m_recording_threads = 1;
+  JobSystem *m_jobs = nullptr;
+  // [frame in flight][chunk], empty when recording inline
+  std::vector<std::vector<RecordingSlot>> m_recording_slots;
+  std::vector<DrawRange> m_draw_ranges;
+  std::vector<DrawCounters> m_chunk_counters;
+  std::vector<ComputePass> m_compute_passes;
+
+  // declared after everything retired objects may release into
+  DeletionQueue m_deletion_queue;
+
+  // declared last: workers are joined before anything their tasks touch
+  std::optional<ThreadPool> m_recorders; // recording_threads() - 1 threads
+  ThreadPool m_workers;
+
+  Renderer(Window *window, VkExtent2D offscreen_extent,
+           const PresentPolicy &present_policy);
+
+  // (re)creates per-frame command pools, buffers and sync primitives, the
+  // device must be idle
+  void make_frame_resources(std::size_t count);
+
+  // blocks while more than `m_max_queued_frames` frames are pending, which
+  // also frees the current slot
+  void limit_queued_frames();
+
+  // grows a host visible per-frame buffer, the old contents are dropped
+  void grow_frame_buffer(Buffer &buffer, VkDeviceSize size,
+                         VkBufferUsageFlags usage);
+
+  // creates the instance set layout and one set per frame slot
+  void make_instance_sets();
+
+  // sorts this frame's draws and splits instanced ones into indirect runs;
+  // instance data and indirect commands, the culler's templates when culling,
+  // are written to the current slot's buffers and its instance set
+  void build_draw_list();
+
+  // points the current slot's instance set at this frame's instance data and
+  // the indices the vertex shader reads it through
+  void update_instance_set(VkBuffer indices);
+
+  // returns the number of draw calls recorded
+  std::size_t record_indirect_draws(VkCommandBuffer command_buffer,
+                                    const IndirectRun &run) const;
+
+  // (re)creates pools and secondaries for every frame slot and chunk
+  void make_recording_slots();
+
+  // starts own recording threads unless a job system is set
+  void make_recorders();
+
+  void set_dynamic_state(VkCommandBuffer command_buffer) const;
+
+  // records the draw list items of `range`; only the render thread may
+  // `profile_draws`
+  DrawCounters record_draws(VkCommandBuffer command_buffer,
+                            const DrawRange &range, bool profile_draws);
+
+  // fills `m_draw_ranges` with at most `chunk_count` ranges
+  void split_draws(std::size_t chunk_count);
+
+  // inside a render pass begun for secondary command buffers
+  void record_draws_parallel(VkCommandBuffer command_buffer,
+                             unsigned image_index);
+
+  // applies the resize policy; false when
+  // nothing can be rendered, e.g. while the window is minimized
+  bool prepare_swapchain();
+
+  void request_swapchain_recreation();
+
+  // builds a new swapchain from the current one, which gets retired
+  void recreate_swapchain();
+
+  // presents the image rendered by the current frame
+  void present(unsigned image_index);
+
+  [[nodiscard]] VkFramebuffer framebuffer(unsigned image_index) const {
+    return m_swapchain ? m_swapchain->framebuffers()[image_index]
+                       : m_offscreen->framebuffers()[image_index];
+  }
+
+  // records one render pass with draws of every submitted mesh whose
+  // pipeline is ready
+  void record_frame(VkCommandBuffer command_buffer, unsigned image_index,
+                    const UploadScheduler::FrameDependencies &uploads);
 };
 
 } // namespace engine::core
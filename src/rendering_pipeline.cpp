@@ -1,7 +1,9 @@
 #include "rendering_pipeline.hpp"
 #include "engine_exceptions.hpp" // for PipelineLayoutCreationError, Render...
+#include "hash.hpp"              // for StateKey
 #include <array>                 // for array
 #include <cstdio>                // for stderr
+#include <memory>                // for make_shared
 #include <print>                 // for println
 #include <stdexcept>             // for out_of_range
 #include <vector>                // for vector
@@ -36,17 +38,46 @@ make_default_pipeline_layout(VkDevice device) {
 [[nodiscard]] VkDestroyable<VkPipelineLayoutWrapper>
 PipelineLayoutMaker::make_pipeline_layout() const {
   VkPipelineLayout layout = VK_NULL_HANDLE;
-  if (vkCreatePipelineLayout(m_device, &m_layout_info, nullptr, &layout) !=
+  // the maker may have been copied, so pointers are refreshed here
+  VkPipelineLayoutCreateInfo layout_info = m_layout_info;
+  layout_info.pPushConstantRanges =
+      layout_info.pushConstantRangeCount != 0 ? &m_range : nullptr;
+  layout_info.pSetLayouts = m_set_layouts.data();
+  if (vkCreatePipelineLayout(m_device, &layout_info, nullptr, &layout) !=
       VK_SUCCESS) {
     throw exceptions::PipelineLayoutCreationError{};
   }
   return {layout, m_device};
 }
 
+[[nodiscard]] StateKey PipelineLayoutMaker::state_key() const {
+  StateKey key;
+  key.add(m_layout_info.setLayoutCount)
+      .add(m_layout_info.pushConstantRangeCount);
+  if (m_layout_info.pushConstantRangeCount != 0) {
+    key.add(m_range.stageFlags).add(m_range.offset).add(m_range.size);
+  }
+  // set layouts by their bindings, equal layouts may have distinct handles
+  for (const auto &bindings : m_set_bindings) {
+    key.add(bindings.size());
+    for (const VkDescriptorSetLayoutBinding &binding : bindings) {
+      key.add(binding.binding)
+          .add(binding.descriptorType)
+          .add(binding.descriptorCount)
+          .add(binding.stageFlags)
+          .add(binding.pImmutableSamplers != nullptr);
+    }
+  }
+  return key;
+}
+
 RenderingPipelineMaker &RenderingPipelineMaker::set_shaders(
     const std::map<Shader::Stage, std::filesystem::path> &shaders) {
   for (const auto &[stage, filename] : shaders) {
-    m_shader_modules.emplace(stage, Shader(m_device, filename));
+    m_shader_modules.emplace(
+        stage, m_shader_cache ? m_shader_cache->get(filename)
+                              : std::make_shared<const Shader>(m_device,
+                                                               filename));
   }
 
   try {
@@ -55,7 +86,7 @@ RenderingPipelineMaker &RenderingPipelineMaker::set_shaders(
         .pNext = nullptr,
         .flags = 0,
         .stage = VK_SHADER_STAGE_VERTEX_BIT,
-        .module = m_shader_modules.at(Shader::Stage::VERTEX).get_module(),
+        .module = m_shader_modules.at(Shader::Stage::VERTEX)->get_module(),
         .pName = "main",
         .pSpecializationInfo = nullptr};
 
@@ -64,7 +95,7 @@ RenderingPipelineMaker &RenderingPipelineMaker::set_shaders(
         .pNext = nullptr,
         .flags = 0,
         .stage = VK_SHADER_STAGE_FRAGMENT_BIT,
-        .module = m_shader_modules.at(Shader::Stage::FRAGMENT).get_module(),
+        .module = m_shader_modules.at(Shader::Stage::FRAGMENT)->get_module(),
         .pName = "main",
         .pSpecializationInfo = nullptr};
 
@@ -77,7 +108,7 @@ RenderingPipelineMaker &RenderingPipelineMaker::set_shaders(
            .pNext = nullptr,
            .flags = 0,
            .stage = VK_SHADER_STAGE_GEOMETRY_BIT,
-           .module = it->second.get_module(),
+           .module = it->second->get_module(),
            .pName = "main",
            .pSpecializationInfo = nullptr});
     }
@@ -88,7 +119,7 @@ RenderingPipelineMaker &RenderingPipelineMaker::set_shaders(
            .pNext = nullptr,
            .flags = 0,
            .stage = VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT,
-           .module = it->second.get_module(),
+           .module = it->second->get_module(),
            .pName = "main",
            .pSpecializationInfo = nullptr});
     }
@@ -99,7 +130,7 @@ RenderingPipelineMaker &RenderingPipelineMaker::set_shaders(
            .pNext = nullptr,
            .flags = 0,
            .stage = VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT,
-           .module = it->second.get_module(),
+           .module = it->second->get_module(),
            .pName = "main",
            .pSpecializationInfo = nullptr});
     }
@@ -211,8 +242,8 @@ RenderingPipelineMaker::set_pipeline_layout(VkPipelineLayout layout) {
 }
 
 [[nodiscard]] VkDestroyable<VkPipelineWrapper>
-RenderingPipelineMaker::make_rendering_pipeline(
-    VkRenderPass render_pass) const {
+RenderingPipelineMaker::make_rendering_pipeline(VkRenderPass render_pass,
+                                                VkPipelineCache cache) const {
   const VkPipelineViewportStateCreateInfo viewport_state = {
       .sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
       .pNext = nullptr,
@@ -242,13 +273,24 @@ RenderingPipelineMaker::make_rendering_pipeline(
   dynamic_info.pDynamicStates = state.data();
   dynamic_info.dynamicStateCount = static_cast<unsigned>(state.size());
 
+  // makers are movable, so pointers into own members are refreshed here
+  VkPipelineRenderingCreateInfo render_info = m_render_info;
+  if (render_info.colorAttachmentCount != 0) {
+    render_info.pColorAttachmentFormats = &m_color_attachment_format;
+  }
+  VkPipelineVertexInputStateCreateInfo vertex_input_info = m_vertex_input_info;
+  if (vertex_input_info.vertexBindingDescriptionCount != 0) {
+    vertex_input_info.pVertexBindingDescriptions = m_vertex_bindings.data();
+    vertex_input_info.pVertexAttributeDescriptions = m_vertex_attributes.data();
+  }
+
   const VkGraphicsPipelineCreateInfo pipeline_info = {
       .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
-      .pNext = &m_render_info,
+      .pNext = &render_info,
       .flags = 0,
       .stageCount = static_cast<unsigned>(m_shader_stages.size()),
       .pStages = m_shader_stages.data(),
-      .pVertexInputState = &m_vertex_input_info,
+      .pVertexInputState = &vertex_input_info,
       .pInputAssemblyState = &m_input_assembly,
       .pTessellationState = nullptr,
       .pViewportState = &viewport_state,
@@ -265,11 +307,72 @@ RenderingPipelineMaker::make_rendering_pipeline(
   };
 
   VkPipeline pipeline = VK_NULL_HANDLE;
-  if (vkCreateGraphicsPipelines(m_device, VK_NULL_HANDLE, 1, &pipeline_info,
+  if (vkCreateGraphicsPipelines(m_device, cache, 1, &pipeline_info,
                                 nullptr, &pipeline) != VK_SUCCESS) {
     throw exceptions::RenderingPipelineCreationError{};
   }
   return {pipeline, m_device};
 } // namespace engine::core
 
+[[nodiscard]] StateKey RenderingPipelineMaker::state_key() const {
+  StateKey key;
+  for (const auto &[stage, shader] : m_shader_modules) {
+    key.add(stage).add(shader->code_hash());
+  }
+
+  key.add(m_input_assembly.topology)
+      .add(m_input_assembly.primitiveRestartEnable);
+
+  key.add(m_rasterizer.depthClampEnable)
+      .add(m_rasterizer.rasterizerDiscardEnable)
+      .add(m_rasterizer.polygonMode)
+      .add(m_rasterizer.cullMode)
+      .add(m_rasterizer.frontFace)
+      .add(m_rasterizer.depthBiasEnable)
+      .add(m_rasterizer.depthBiasConstantFactor)
+      .add(m_rasterizer.depthBiasClamp)
+      .add(m_rasterizer.depthBiasSlopeFactor)
+      .add(m_rasterizer.lineWidth);
+
+  key.add(m_multisampling.rasterizationSamples)
+      .add(m_multisampling.sampleShadingEnable)
+      .add(m_multisampling.minSampleShading)
+      .add(m_multisampling.alphaToCoverageEnable)
+      .add(m_multisampling.alphaToOneEnable);
+
+  key.add(m_color_blend_attachment.blendEnable)
+      .add(m_color_blend_attachment.srcColorBlendFactor)
+      .add(m_color_blend_attachment.dstColorBlendFactor)
+      .add(m_color_blend_attachment.colorBlendOp)
+      .add(m_color_blend_attachment.srcAlphaBlendFactor)
+      .add(m_color_blend_attachment.dstAlphaBlendFactor)
+      .add(m_color_blend_attachment.alphaBlendOp)
+      .add(m_color_blend_attachment.colorWriteMask);
+
+  key.add(m_depth_stencil.depthTestEnable)
+      .add(m_depth_stencil.depthWriteEnable)
+      .add(m_depth_stencil.depthCompareOp)
+      .add(m_depth_stencil.depthBoundsTestEnable)
+      .add(m_depth_stencil.stencilTestEnable)
+      .add(m_depth_stencil.minDepthBounds)
+      .add(m_depth_stencil.maxDepthBounds);
+
+  key.add(m_render_info.colorAttachmentCount)
+      .add(m_color_attachment_format)
+      .add(m_render_info.depthAttachmentFormat)
+      .add(m_render_info.stencilAttachmentFormat);
+
+  key.add(m_vertex_input_info.vertexBindingDescriptionCount);
+  for (const auto &binding : m_vertex_bindings) {
+    key.add(binding.binding).add(binding.stride).add(binding.inputRate);
+  }
+  for (const auto &attribute : m_vertex_attributes) {
+    key.add(attribute.location)
+        .add(attribute.binding)
+        .add(attribute.format)
+        .add(attribute.offset);
+  }
+  return key;
+}
+
 } // namespace engine::core
@@ -1,8 +1,11 @@
 #pragma once
 
+#include "hash.hpp"               // for StateKey
 #include "shader.hpp"             // for Shader
+#include "shader_cache.hpp"       // for ShaderCache, SharedShader
 #include "vulkan_destroyable.hpp" // for VkDestroyable, VkPipelineLayoutWra...
 #include <cstddef>                // for size_t
+#include <cstdint>                // for uint64_t
 #include <filesystem>             // for path
 #include <map>                    // for map, swap
 #include <span>                   // for span
@@ -15,7 +18,7 @@ namespace engine::core {
 class RenderingPipelineMaker {
 private:
   std::vector<VkPipelineShaderStageCreateInfo> m_shader_stages;
-  std::map<Shader::Stage, Shader> m_shader_modules;
+  std::map<Shader::Stage, SharedShader> m_shader_modules;
 
   VkPipelineInputAssemblyStateCreateInfo m_input_assembly{};
   VkPipelineRasterizationStateCreateInfo m_rasterizer{};
@@ -25,13 +28,30 @@ private:
   VkPipelineDepthStencilStateCreateInfo m_depth_stencil{};
   VkPipelineRenderingCreateInfo m_render_info{};
   VkFormat m_color_attachment_format{};
-  VkVertexInputBindingDescription m_vertex_binding{};
+  std::vector<VkVertexInputBindingDescription> m_vertex_bindings;
   std::vector<VkVertexInputAttributeDescription> m_vertex_attributes;
   VkPipelineVertexInputStateCreateInfo m_vertex_input_info{};
   VkDevice m_device = VK_NULL_HANDLE;
+  ShaderCache *m_shader_cache = nullptr;
+
+  RenderingPipelineMaker &update_vertex_input_info() {
+    m_vertex_input_info.vertexBindingDescriptionCount =
+        static_cast<unsigned>(m_vertex_bindings.size());
+    m_vertex_input_info.pVertexBindingDescriptions = m_vertex_bindings.data();
+
+    m_vertex_input_info.vertexAttributeDescriptionCount =
+        static_cast<unsigned>(m_vertex_attributes.size());
+    m_vertex_input_info.pVertexAttributeDescriptions =
+        m_vertex_attributes.data();
+    return *this;
+  }
 
 public:
-  RenderingPipelineMaker(VkDevice device) : m_device(device) { reset(); };
+  // without a cache every maker loads and owns its own shader modules
+  RenderingPipelineMaker(VkDevice device, ShaderCache *shader_cache = nullptr)
+      : m_device(device), m_shader_cache(shader_cache) {
+    reset();
+  };
 
   RenderingPipelineMaker &reset();
 
@@ -60,21 +80,29 @@ public:
   RenderingPipelineMaker &set_vertex_description(
       VkVertexInputBindingDescription binding,
       std::span<VkVertexInputAttributeDescription> attributes) {
-    m_vertex_binding = binding;
+    m_vertex_bindings.assign(1, binding);
     m_vertex_attributes = std::vector(attributes.begin(), attributes.end());
+    return update_vertex_input_info();
+  }
 
-    m_vertex_input_info.vertexBindingDescriptionCount = 1;
-    m_vertex_input_info.pVertexBindingDescriptions = &m_vertex_binding;
-
-    m_vertex_input_info.vertexAttributeDescriptionCount =
-        static_cast<unsigned>(m_vertex_attributes.size());
-    m_vertex_input_info.pVertexAttributeDescriptions =
-        m_vertex_attributes.data();
-    return *this;
+  // adds a binding next to the one given to `set_vertex_description`, e.g.
+  // per-instance data with VK_VERTEX_INPUT_RATE_INSTANCE
+  RenderingPipelineMaker &add_vertex_description(
+      VkVertexInputBindingDescription binding,
+      std::span<VkVertexInputAttributeDescription> attributes) {
+    m_vertex_bindings.push_back(binding);
+    m_vertex_attributes.insert(m_vertex_attributes.end(), attributes.begin(),
+                               attributes.end());
+    return update_vertex_input_info();
   }
 
   VkDestroyable<VkPipelineWrapper>
-  make_rendering_pipeline(VkRenderPass render_pass) const;
+  make_rendering_pipeline(VkRenderPass render_pass,
+                          VkPipelineCache cache = VK_NULL_HANDLE) const;
+
+  // everything that affects the created pipeline except the layout handle;
+  // shaders contribute their SPIR-V hash, not module handles
+  [[nodiscard]] StateKey state_key() const;
 
   RenderingPipelineMaker(const RenderingPipelineMaker &) = delete;
   RenderingPipelineMaker &operator=(const RenderingPipelineMaker &) = delete;
@@ -96,10 +124,11 @@ public:
       std::swap(m_depth_stencil, other.m_depth_stencil);
       std::swap(m_render_info, other.m_render_info);
       std::swap(m_color_attachment_format, other.m_color_attachment_format);
-      std::swap(m_vertex_binding, other.m_vertex_binding);
+      std::swap(m_vertex_bindings, other.m_vertex_bindings);
       std::swap(m_vertex_attributes, other.m_vertex_attributes);
       std::swap(m_vertex_input_info, other.m_vertex_input_info);
       std::swap(m_device, other.m_device);
+      std::swap(m_shader_cache, other.m_shader_cache);
     }
     return *this;
   }
@@ -125,6 +154,9 @@ private:
       make_default_pipeline_layout_create_info();
   VkDevice m_device = VK_NULL_HANDLE;
   VkPushConstantRange m_range{};
+  std::vector<VkDescriptorSetLayout> m_set_layouts;
+  // what the layouts were created from, handles say nothing about equality
+  std::vector<std::vector<VkDescriptorSetLayoutBinding>> m_set_bindings;
 
 public:
   PipelineLayoutMaker(VkDevice device) : m_device(device) {}
@@ -141,8 +173,21 @@ public:
     return *this;
   }
 
+  // set numbers follow the order of calls; `bindings` are the ones
+  // `set_layout` was created with
+  PipelineLayoutMaker &add_descriptor_set_layout(
+      VkDescriptorSetLayout set_layout,
+      std::span<const VkDescriptorSetLayoutBinding> bindings) {
+    m_set_layouts.push_back(set_layout);
+    m_set_bindings.emplace_back(bindings.begin(), bindings.end());
+    m_layout_info.setLayoutCount = static_cast<unsigned>(m_set_layouts.size());
+    return *this;
+  }
+
   [[nodiscard]] VkDestroyable<VkPipelineLayoutWrapper>
   make_pipeline_layout() const;
+
+  [[nodiscard]] StateKey state_key() const;
 };
 
 } // namespace engine::core
@@ -1,11 +1,13 @@
 #include "shader.hpp"
 #include "engine_exceptions.hpp" // for ShaderModuleCreationError
+#include "hash.hpp"              // for Hasher
 
 namespace engine::core {
 
-Shader::Shader(VkDevice device, const std::filesystem::path &relative_path) {
-  const std::vector<char> code = read_file(PATH_TO_SHADERS / relative_path);
+Shader::Shader(VkDevice device, const std::filesystem::path &relative_path)
+    : Shader(device, read_file(PATH_TO_SHADERS / relative_path)) {}
 
+Shader::Shader(VkDevice device, std::span<const char> code) {
   const VkShaderModuleCreateInfo create_info{
       .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
       .pNext = nullptr,
@@ -19,6 +21,7 @@ Shader::Shader(VkDevice device, const std::filesystem::path &relative_path) {
     throw exceptions::ShaderModuleCreationError{};
   }
   m_module = {module, device};
+  m_code_hash = Hasher{}.add(std::as_bytes(std::span(code))).value();
 }
 
 } // namespace engine::core
@@ -3,9 +3,10 @@
 #include "meta.hpp"               // for PATH_TO_BINARIES
 #include "vulkan_destroyable.hpp" // for VkDestroyable, VkShaderModuleWrapper
 #include <cstddef>                // for size_t
-#include <cstdint>                // for uint8_t
+#include <cstdint>                // for uint8_t, uint64_t
 #include <filesystem>             // for path, operator/
 #include <fstream>                // for basic_ifstream, operator|, basic_ios
+#include <span>                   // for span
 #include <vector>                 // for vector
 #include <vulkan/vulkan_core.h>   // for VkDevice, VkShaderModule
 
@@ -23,6 +24,8 @@ public:
   };
 
 private:
+  friend class ShaderCache;
+
   static std::vector<char> read_file(const std::filesystem::path &path) {
     std::ifstream file(path, std::ios::ate | std::ios::binary);
     file.exceptions(std::ios_base::failbit | std::ios_base::badbit);
@@ -36,11 +39,15 @@ private:
       PATH_TO_BINARIES / "compiled_shaders/";
 
   VkDestroyable<VkShaderModuleWrapper> m_module;
+  std::uint64_t m_code_hash = 0;
 
 public:
   Shader(VkDevice device, const std::filesystem::path &relative_path);
+  Shader(VkDevice device, std::span<const char> code);
 
   [[nodiscard]] VkShaderModule get_module() const { return m_module; }
+  // hash of SPIR-V contents, identical code gives identical hash
+  [[nodiscard]] std::uint64_t code_hash() const { return m_code_hash; }
 };
 
 } // namespace engine::core
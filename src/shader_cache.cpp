@@ -0,0 +1,73 @@
+#include "shader_cache.hpp"
+#include "cpu_profiler.hpp" // for CpuScope
+#include "hash.hpp"         // for Hasher
+#include <span>             // for as_bytes, span
+#include <string>           // for string
+#include <utility>          // for move
+#include <vector>           // for vector
+
+namespace engine::core {
+
+SharedShader ShaderCache::get(const std::filesystem::path &relative_path) {
+  const std::string key = relative_path.generic_string();
+  {
+    const std::lock_guard lock(m_mutex);
+    if (auto path = m_paths.find(key); path != m_paths.end()) {
+      if (auto module = m_modules.find(path->second);
+          module != m_modules.end()) {
+        ++m_hits;
+        return module->second;
+      }
+    }
+  }
+
+  const CpuScope scope("load shader");
+  // file io and module creation run unlocked, materials are built on workers
+  const std::vector<char> code =
+      Shader::read_file(Shader::PATH_TO_SHADERS / relative_path);
+  const std::uint64_t hash =
+      Hasher{}.add(std::as_bytes(std::span(code))).value();
+
+  {
+    const std::lock_guard lock(m_mutex);
+    ++m_misses;
+    m_paths.insert_or_assign(key, hash);
+    if (auto module = m_modules.find(hash); module != m_modules.end()) {
+      ++m_deduplicated;
+      return module->second;
+    }
+  }
+
+  auto shader = std::make_shared<const Shader>(m_device, std::span(code));
+
+  const std::lock_guard lock(m_mutex);
+  // another thread may have created the same module meanwhile, keep theirs
+  return m_modules.try_emplace(hash, std::move(shader)).first->second;
+}
+
+void ShaderCache::invalidate(const std::filesystem::path &relative_path) {
+  const std::lock_guard lock(m_mutex);
+  m_paths.erase(relative_path.generic_string());
+}
+
+std::size_t ShaderCache::evict_unused() {
+  const std::lock_guard lock(m_mutex);
+  const std::size_t evicted = std::erase_if(m_modules, [](const auto &entry) {
+    return entry.second.use_count() == 1;
+  });
+  // paths to evicted modules would only miss now, drop them as well
+  std::erase_if(m_paths, [this](const auto &entry) {
+    return !m_modules.contains(entry.second);
+  });
+  return evicted;
+}
+
+ShaderCache::Stats ShaderCache::stats() const {
+  const std::lock_guard lock(m_mutex);
+  return {.hits = m_hits,
+          .misses = m_misses,
+          .deduplicated = m_deduplicated,
+          .live_modules = m_modules.size()};
+}
+
+} // namespace engine::core
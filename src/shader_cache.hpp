@@ -0,0 +1,62 @@
+#pragma once
+
+#include "shader.hpp"           // for Shader
+#include <cstddef>              // for size_t
+#include <cstdint>              // for uint64_t
+#include <filesystem>           // for path
+#include <memory>               // for shared_ptr
+#include <mutex>                // for mutex
+#include <string>               // for string
+#include <unordered_map>        // for unordered_map
+#include <vulkan/vulkan_core.h> // for VkDevice
+
+namespace engine::core {
+
+using SharedShader = std::shared_ptr<const Shader>;
+
+// Content-addressed shader modules. A path is read from disk once and mapped
+// to the hash of its SPIR-V; modules are keyed by that hash, so identical
+// code behind different paths shares one `VkShaderModule`. Modules are only
+// needed while pipelines are created, `evict_unused` drops the ones no
+// pipeline maker holds anymore.
+class ShaderCache {
+public:
+  struct Stats {
+    std::size_t hits = 0;         // served without touching the filesystem
+    std::size_t misses = 0;       // file read from disk
+    std::size_t deduplicated = 0; // file read, but the module already existed
+    std::size_t live_modules = 0;
+  };
+
+  explicit ShaderCache(VkDevice device) : m_device(device) {}
+
+  // `relative_path` is relative to the compiled shaders directory
+  [[nodiscard]] SharedShader get(const std::filesystem::path &relative_path);
+
+  // forgets the file behind `relative_path`, next `get` reads it again
+  void invalidate(const std::filesystem::path &relative_path);
+
+  // destroys modules referenced by nothing but the cache, returns their count
+  std::size_t evict_unused();
+
+  [[nodiscard]] Stats stats() const;
+
+  ShaderCache(const ShaderCache &) = delete;
+  ShaderCache(ShaderCache &&) noexcept = delete;
+  ShaderCache &operator=(const ShaderCache &) = delete;
+  ShaderCache &operator=(ShaderCache &&) noexcept = delete;
+  ~ShaderCache() = default;
+
+private:
+  VkDevice m_device = VK_NULL_HANDLE;
+  // generic path string -> hash of its contents
+  std::unordered_map<std::string, std::uint64_t> m_paths;
+  // hash of contents -> module
+  std::unordered_map<std::uint64_t, SharedShader> m_modules;
+  std::size_t m_hits = 0;
+  std::size_t m_misses = 0;
+  std::size_t m_deduplicated = 0;
+  mutable std::mutex m_mutex;
+};
+
+} // namespace engine::core
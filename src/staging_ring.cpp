@@ -0,0 +1,103 @@
+#include "staging_ring.hpp"
+#include "engine_exceptions.hpp" // for StagingRingOverflowError
+#include "renderer.hpp"          // for Renderer
+
+namespace engine::core {
+
+namespace {
+
+VkDeviceSize align_up(VkDeviceSize value, VkDeviceSize alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+StagingRing::StagingRing(Renderer &renderer, VkDeviceSize capacity)
+    : m_buffer(renderer, capacity, VK_BUFFER_USAGE_TRANSFER_SRC_BIT),
+      m_timeline(renderer.device()), m_capacity(capacity) {
+  m_buffer.allocate(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                    VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+}
+
+StagingRing::~StagingRing() { m_timeline.wait(m_submitted); }
+
+std::optional<StagingRing::Region>
+StagingRing::try_allocate(VkDeviceSize size, VkDeviceSize alignment) {
+  reclaim();
+
+  if (m_used == 0) {
+    m_head = m_tail = 0;
+  }
+
+  VkDeviceSize offset = 0;
+  VkDeviceSize consumed = 0;
+  const VkDeviceSize aligned = align_up(m_head, alignment);
+  if (m_head > m_tail || m_used == 0) {
+    // free space is [head, capacity) and [0, tail)
+    if (aligned + size <= m_capacity) {
+      offset = aligned;
+      consumed = aligned - m_head + size;
+    } else if (size <= m_tail) {
+      offset = 0;
+      consumed = m_capacity - m_head + size;
+    } else {
+      return std::nullopt;
+    }
+  } else {
+    // wrapped: free space is [head, tail)
+    if (aligned + size > m_tail) {
+      return std::nullopt;
+    }
+    offset = aligned;
+    consumed = aligned - m_head + size;
+  }
+
+  m_head = offset + size;
+  m_used += consumed;
+  m_open_bytes += consumed;
+  return Region{.buffer = m_buffer.buffer(),
+                .offset = offset,
+                .size = size,
+                .data = m_buffer.mapped() + offset};
+}
+
+StagingRing::Region StagingRing::allocate(VkDeviceSize size,
+                                          VkDeviceSize alignment) {
+  if (size > m_capacity) {
+    throw exceptions::StagingRingOverflowError{};
+  }
+  while (true) {
+    if (auto region = try_allocate(size, alignment)) {
+      return *region;
+    }
+    if (m_in_flight.empty()) {
+      // only regions of a not yet submitted batch occupy the ring
+      throw exceptions::StagingRingOverflowError{};
+    }
+    m_timeline.wait(m_in_flight.front().value);
+  }
+}
+
+std::uint64_t StagingRing::close_submission() {
+  m_submitted = m_timeline.next_value();
+  m_in_flight.push_back({.bytes = m_open_bytes, .value = m_submitted});
+  m_open_bytes = 0;
+  return m_submitted;
+}
+
+void StagingRing::reclaim() {
+  if (m_in_flight.empty()) {
+    return;
+  }
+  // one counter read covers every finished submission
+  const std::uint64_t completed = m_timeline.completed_value();
+  while (!m_in_flight.empty() && m_in_flight.front().value <= completed) {
+    const auto &submission = m_in_flight.front();
+    m_tail = (m_tail + submission.bytes) % m_capacity;
+    m_used -= submission.bytes;
+    m_completed = submission.value;
+    m_in_flight.pop_front();
+  }
+}
+
+} // namespace engine::core
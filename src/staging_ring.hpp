@@ -0,0 +1,88 @@
+#pragma once
+
+#include "synchronization.hpp"  // for TimelineSemaphore
+#include "vulkan_buffers.hpp"   // for Buffer
+#include <cstddef>              // for byte, size_t
+#include <cstdint>              // for uint64_t
+#include <deque>                // for deque
+#include <optional>             // for optional
+#include <vulkan/vulkan_core.h> // for VkBuffer, VkDeviceSize, VkSemaphore
+
+namespace engine::core {
+
+class Renderer;
+
+// Long-lived, persistently mapped host visible buffer that uploads are carved
+// out of. Regions handed out since the last `close_submission` belong to the
+// timeline value it returns; that space is reused once the value is reached.
+class StagingRing {
+public:
+  struct Region {
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;
+    VkDeviceSize size = 0;
+    std::byte *data = nullptr;
+  };
+
+  static constexpr VkDeviceSize DEFAULT_CAPACITY = 32ull << 20;
+
+  StagingRing(Renderer &renderer, VkDeviceSize capacity = DEFAULT_CAPACITY);
+
+  // does not block, returns nullopt when the ring has no room right now
+  [[nodiscard]] std::optional<Region> try_allocate(VkDeviceSize size,
+                                                   VkDeviceSize alignment = 16);
+
+  // waits for in-flight submissions until `size` bytes fit
+  [[nodiscard]] Region allocate(VkDeviceSize size,
+                                VkDeviceSize alignment = 16);
+
+  // the returned value of `timeline()` must be signalled by the submit
+  // consuming the regions allocated since the previous call
+  [[nodiscard]] std::uint64_t close_submission();
+
+  // returns space of every finished submission back to the ring
+  void reclaim();
+
+  // submissions are numbered from 1 in `close_submission` order, the number
+  // is the timeline value they signal; they are reclaimed in that order
+  [[nodiscard]] VkSemaphore timeline() const { return m_timeline.semaphore(); }
+  [[nodiscard]] std::uint64_t submitted_count() const { return m_submitted; }
+  [[nodiscard]] std::uint64_t completed_count() const { return m_completed; }
+
+  // whether `submission` finished, without reclaiming its space
+  [[nodiscard]] bool finished(std::uint64_t submission) const {
+    return m_timeline.reached(submission);
+  }
+
+  [[nodiscard]] VkDeviceSize capacity() const { return m_capacity; }
+  [[nodiscard]] VkDeviceSize used() const { return m_used; }
+
+  StagingRing(const StagingRing &) = delete;
+  StagingRing(StagingRing &&) noexcept = delete;
+  StagingRing &operator=(const StagingRing &) = delete;
+  StagingRing &operator=(StagingRing &&) noexcept = delete;
+
+  ~StagingRing();
+
+private:
+  struct Submission {
+    VkDeviceSize bytes = 0;
+    std::uint64_t value = 0;
+  };
+
+  Buffer m_buffer;
+  TimelineSemaphore m_timeline;
+  VkDeviceSize m_capacity = 0;
+
+  VkDeviceSize m_head = 0;
+  VkDeviceSize m_tail = 0;
+  VkDeviceSize m_used = 0;       // bytes between tail and head, incl. padding
+  VkDeviceSize m_open_bytes = 0; // bytes not yet bound to a submission
+
+  std::uint64_t m_submitted = 0;
+  std::uint64_t m_completed = 0;
+
+  std::deque<Submission> m_in_flight;
+};
+
+} // namespace engine::core
@@ -2,17 +2,16 @@
 #include "engine_exceptions.hpp"       // for FramebufferCreationError, Ima...
 #include "physical_device_queries.hpp" // for QueueFamilyIndices, find_queu...
 #include "window.hpp"                  // for Window
-#include <algorithm>                   // for clamp, find_if
+#include <algorithm>                   // for clamp, find, find_if, max
 #include <array>                       // for array
 #include <cassert>                     // for assert
 #include <limits>                      // for numeric_limits
 #include <optional>                    // for optional, operator!=
+#include <span>                        // for span
 #include <vulkan/vulkan_core.h>        // for VkPresentModeKHR, VkStructure...
 
 namespace engine::core {
 
-namespace {
-
 VkImageView make_image_view(VkDevice device, VkImage image, VkFormat format,
                             VkImageAspectFlags aspect_flags) {
   const VkImageViewCreateInfo view_info{
@@ -36,6 +35,48 @@ VkImageView make_image_view(VkDevice device, VkImage image, VkFormat format,
   return view;
 }
 
+std::string_view present_mode_name(VkPresentModeKHR mode) {
+  switch (mode) {
+  case VK_PRESENT_MODE_IMMEDIATE_KHR:
+    return "immediate";
+  case VK_PRESENT_MODE_MAILBOX_KHR:
+    return "mailbox";
+  case VK_PRESENT_MODE_FIFO_KHR:
+    return "fifo";
+  case VK_PRESENT_MODE_FIFO_RELAXED_KHR:
+    return "fifo relaxed";
+  default:
+    return "unknown";
+  }
+}
+
+namespace {
+
+std::span<const VkPresentModeKHR>
+present_mode_preference(PresentPolicy::Mode mode) {
+  static constexpr std::array<VkPresentModeKHR, 1> VSYNC_MODES = {
+      VK_PRESENT_MODE_FIFO_KHR};
+  static constexpr std::array<VkPresentModeKHR, 1> LOW_LATENCY_MODES = {
+      VK_PRESENT_MODE_MAILBOX_KHR};
+  static constexpr std::array<VkPresentModeKHR, 2> IMMEDIATE_MODES = {
+      VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_MAILBOX_KHR};
+  static constexpr std::array<VkPresentModeKHR, 1> RELAXED_VSYNC_MODES = {
+      VK_PRESENT_MODE_FIFO_RELAXED_KHR};
+
+  using enum PresentPolicy::Mode;
+  switch (mode) {
+  case VSYNC:
+    return VSYNC_MODES;
+  case LOW_LATENCY:
+    return LOW_LATENCY_MODES;
+  case IMMEDIATE:
+    return IMMEDIATE_MODES;
+  case RELAXED_VSYNC:
+    return RELAXED_VSYNC_MODES;
+  }
+  return {};
+}
+
 } // namespace
 
 Swapchain::SupportDetails
@@ -59,14 +100,16 @@ Swapchain::get_swapchain_support_details(VkPhysicalDevice device,
   if (present_modes_count != 0) {
     details.present_modes.resize(present_modes_count);
     vkGetPhysicalDeviceSurfacePresentModesKHR(device, surface,
-                                              &present_modes_count, nullptr);
+                                              &present_modes_count,
+                                              details.present_modes.data());
   }
   return details;
 }
 
 Swapchain::Swapchain(VkDevice device, VkPhysicalDevice physical_device,
                      VkSurfaceKHR surface, const Window &window,
-                     VkRenderPass render_pass)
+                     const PresentPolicy &policy, VkRenderPass render_pass,
+                     VkSwapchainKHR old_swapchain)
     : m_device(device) {
   auto [surface_capabilities, surface_formats, present_modes] =
       get_swapchain_support_details(physical_device, surface);
@@ -81,13 +124,15 @@ Swapchain::Swapchain(VkDevice device, VkPhysicalDevice physical_device,
       surface_format_it == surface_formats.end() ? surface_formats.front()
                                                  : *surface_format_it;
 
-  auto present_mode_it = std::find_if(
-      present_modes.begin(), present_modes.end(), [](VkPresentModeKHR mode) {
-        return mode == VK_PRESENT_MODE_MAILBOX_KHR;
-      });
-  const VkPresentModeKHR present_mode = present_mode_it == present_modes.end()
-                                            ? VK_PRESENT_MODE_FIFO_KHR
-                                            : *present_mode_it;
+  // FIFO support is required by the spec
+  VkPresentModeKHR present_mode = VK_PRESENT_MODE_FIFO_KHR;
+  for (VkPresentModeKHR preferred : present_mode_preference(policy.mode)) {
+    if (std::find(present_modes.begin(), present_modes.end(), preferred) !=
+        present_modes.end()) {
+      present_mode = preferred;
+      break;
+    }
+  }
 
   if (surface_capabilities.currentExtent.width !=
       std::numeric_limits<unsigned>::max()) {
@@ -101,7 +146,10 @@ Swapchain::Swapchain(VkDevice device, VkPhysicalDevice physical_device,
                            surface_capabilities.maxImageExtent.height)};
   }
 
-  unsigned image_count = surface_capabilities.minImageCount + 1;
+  unsigned image_count = policy.image_count != 0
+                             ? policy.image_count
+                             : surface_capabilities.minImageCount + 1;
+  image_count = std::max(image_count, surface_capabilities.minImageCount);
   if (surface_capabilities.maxImageCount > 0 &&
       image_count > surface_capabilities.maxImageCount) {
     image_count = surface_capabilities.maxImageCount;
@@ -124,7 +172,7 @@ Swapchain::Swapchain(VkDevice device, VkPhysicalDevice physical_device,
                    .compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
                    .presentMode = present_mode,
                    .clipped = VK_TRUE,
-                   .oldSwapchain = VK_NULL_HANDLE};
+                   .oldSwapchain = old_swapchain};
 
   const QueueFamilyIndices ind = find_queue_families(physical_device, surface);
   assert(ind.graphics_family && ind.present_family);
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "vulkan_destroyable.hpp" // for VkDestroyable, VkFramebufferWrapper
+#include <cstddef>                // for size_t
+#include <string_view>            // for string_view
 #include <vector>                 // for vector
 #include <vulkan/vulkan_core.h>   // for VkDevice, VkExtent2D, VkFormat
 
@@ -8,6 +10,26 @@ namespace engine::core {
 
 struct Window;
 
+VkImageView make_image_view(VkDevice device, VkImage image, VkFormat format,
+                            VkImageAspectFlags aspect_flags);
+
+// How frames are handed to the display. A mode the surface does not support
+// falls back along its chain, FIFO is always available as the last resort.
+struct PresentPolicy {
+  enum class Mode {
+    VSYNC,         // FIFO
+    LOW_LATENCY,   // MAILBOX, FIFO
+    IMMEDIATE,     // IMMEDIATE, MAILBOX, FIFO
+    RELAXED_VSYNC, // FIFO_RELAXED, FIFO
+  };
+
+  Mode mode = Mode::LOW_LATENCY;
+  // 0 -- one more than the surface minimum, clamped to the surface limits
+  unsigned image_count = 0;
+};
+
+[[nodiscard]] std::string_view present_mode_name(VkPresentModeKHR mode);
+
 class Swapchain {
 private:
   VkFormat m_image_format{};
@@ -30,9 +52,13 @@ private:
                                                VkSurfaceKHR surface);
 
 public:
+  // passing the swapchain being replaced as `old_swapchain` lets the driver
+  // hand its resources over; the old one must still be destroyed afterwards
   Swapchain(VkDevice device, VkPhysicalDevice physical_device,
             VkSurfaceKHR surface, const Window &window,
-            VkRenderPass render_pass = VK_NULL_HANDLE);
+            const PresentPolicy &policy = {},
+            VkRenderPass render_pass = VK_NULL_HANDLE,
+            VkSwapchainKHR old_swapchain = VK_NULL_HANDLE);
 
   // once render pass created, it bootstraps framebuffers
   void make_framebuffers(VkRenderPass render_pass);
@@ -40,6 +66,11 @@ public:
   [[nodiscard]] VkFormat image_format() const { return m_image_format; }
   [[nodiscard]] VkExtent2D extent() const { return m_extent; }
   [[nodiscard]] VkSwapchainKHR swapchain() const { return m_swapchain; }
+  // what the policy resolved to on this surface
+  [[nodiscard]] VkPresentModeKHR present_mode() const {
+    return m_create_info.presentMode;
+  }
+  [[nodiscard]] std::size_t image_count() const { return m_images.size(); }
   [[nodiscard]] const std::vector<VkDestroyable<VkFramebufferWrapper>> &
   framebuffers() const {
     return m_framebuffers;
@@ -1,25 +1,32 @@
 #include "synchronization.hpp"
-#include "engine_exceptions.hpp" // for SyncPrimitivesCreationError
+#include "engine_exceptions.hpp" // for SemaphoreWaitError, SyncPrimitive...
+#include <limits>                // for numeric_limits
 
 namespace engine::core {
 
-Fence::Fence(VkDevice device) : m_device(device) {
-  const VkFenceCreateInfo fence_create_info{
-      .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+Semaphore::Semaphore(VkDevice device) {
+  const VkSemaphoreCreateInfo sem_create_info{
+      .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
       .pNext = nullptr,
-      .flags = VK_FENCE_CREATE_SIGNALED_BIT};
-  VkFence fence = VK_NULL_HANDLE;
-  if (vkCreateFence(device, &fence_create_info, nullptr, &fence) !=
+      .flags = 0};
+
+  VkSemaphore semaphore = VK_NULL_HANDLE;
+  if (vkCreateSemaphore(device, &sem_create_info, nullptr, &semaphore) !=
       VK_SUCCESS) {
     throw exceptions::SyncPrimitivesCreationError{};
   }
-  m_fence = {fence, device};
+  m_semaphore = {semaphore, device};
 }
 
-Semaphore::Semaphore(VkDevice device) {
+TimelineSemaphore::TimelineSemaphore(VkDevice device) : m_device(device) {
+  const VkSemaphoreTypeCreateInfo type_create_info{
+      .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+      .pNext = nullptr,
+      .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+      .initialValue = 0};
   const VkSemaphoreCreateInfo sem_create_info{
       .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
-      .pNext = nullptr,
+      .pNext = &type_create_info,
       .flags = 0};
 
   VkSemaphore semaphore = VK_NULL_HANDLE;
@@ -30,4 +37,46 @@ Semaphore::Semaphore(VkDevice device) {
   m_semaphore = {semaphore, device};
 }
 
+std::uint64_t TimelineSemaphore::completed_value() const {
+  std::uint64_t value = 0;
+  if (vkGetSemaphoreCounterValue(m_device, m_semaphore, &value) !=
+      VK_SUCCESS) {
+    throw exceptions::SemaphoreWaitError{};
+  }
+  publish_completed(value);
+  return value;
+}
+
+void TimelineSemaphore::publish_completed(std::uint64_t value) const {
+  // concurrent pollers may read back values out of order, keep the highest
+  std::uint64_t current = m_completed.load(std::memory_order_relaxed);
+  while (current < value &&
+         !m_completed.compare_exchange_weak(current, value,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed)) {
+  }
+}
+
+void TimelineSemaphore::wait(std::uint64_t value) const {
+  if (value <= m_completed.load(std::memory_order_acquire)) {
+    return;
+  }
+  const VkSemaphore semaphore = m_semaphore;
+  const VkSemaphoreWaitInfo wait_info{
+      .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+      .pNext = nullptr,
+      .flags = 0,
+      .semaphoreCount = 1,
+      .pSemaphores = &semaphore,
+      .pValues = &value};
+  // anything else than success, a timeout included, means `value` may not
+  // have been reached and nothing guarded by it may be reused
+  if (vkWaitSemaphores(m_device, &wait_info,
+                       std::numeric_limits<std::uint64_t>::max()) !=
+      VK_SUCCESS) {
+    throw exceptions::SemaphoreWaitError{};
+  }
+  publish_completed(value);
+}
+
 } // namespace engine::core
@@ -1,42 +1,65 @@
 #pragma once
 
-#include "vulkan_destroyable.hpp" // for VkDestroyable, VkFenceWrapper, VkS...
+#include "vulkan_destroyable.hpp" // for VkDestroyable, VkSemaphoreWrapper
+#include <atomic>                 // for atomic, memory_order
 #include <cstdint>                // for uint64_t
-#include <limits>                 // for numeric_limits
-#include <vulkan/vulkan_core.h>   // for VkDevice, vkResetFences, vkWaitFor...
+#include <vulkan/vulkan_core.h>   // for VkDevice, VkSemaphore
 
 namespace engine::core {
 
-class Fence {
+class Semaphore {
 private:
-  VkDestroyable<VkFenceWrapper> m_fence;
-  VkDevice m_device = VK_NULL_HANDLE;
+  VkDestroyable<VkSemaphoreWrapper> m_semaphore;
 
 public:
-  Fence() = default;
-
-  Fence(VkDevice device);
-
-  void wait() {
-    vkWaitForFences(m_device, 1, &m_fence, VK_TRUE,
-                    std::numeric_limits<std::uint64_t>::max());
-  }
+  Semaphore() = default;
 
-  void reset() { vkResetFences(m_device, 1, &m_fence); }
+  Semaphore(VkDevice device);
 
-  [[nodiscard]] VkFence fence() const { return m_fence; }
+  [[nodiscard]] VkSemaphore semaphore() const { return m_semaphore; }
 };
 
-class Semaphore {
+// Counter advanced by the GPU: every submit signals the next value, so
+// progress of a whole stream of submits is tracked by one object. Polling
+// asks the driver only when the cached completed value is not enough.
+// Polling and waiting may happen on any thread; handing out values belongs
+// to the thread that submits.
+class TimelineSemaphore {
 private:
   VkDestroyable<VkSemaphoreWrapper> m_semaphore;
+  VkDevice m_device = VK_NULL_HANDLE;
+  std::uint64_t m_signalled = 0; // highest value handed to a submit
+  // last value read back, only ever raised
+  mutable std::atomic<std::uint64_t> m_completed = 0;
+
+  void publish_completed(std::uint64_t value) const;
 
 public:
-  Semaphore() = default;
+  TimelineSemaphore() = default;
 
-  Semaphore(VkDevice device);
+  TimelineSemaphore(VkDevice device);
+
+  // value the next submit has to signal
+  [[nodiscard]] std::uint64_t next_value() { return ++m_signalled; }
+  [[nodiscard]] std::uint64_t signalled_value() const { return m_signalled; }
+
+  [[nodiscard]] std::uint64_t completed_value() const;
+
+  // never blocks
+  [[nodiscard]] bool reached(std::uint64_t value) const {
+    return value <= m_completed.load(std::memory_order_acquire) ||
+           value <= completed_value();
+  }
+
+  void wait(std::uint64_t value) const;
 
   [[nodiscard]] VkSemaphore semaphore() const { return m_semaphore; }
+
+  TimelineSemaphore(const TimelineSemaphore &) = delete;
+  TimelineSemaphore(TimelineSemaphore &&) noexcept = delete;
+  TimelineSemaphore &operator=(const TimelineSemaphore &) = delete;
+  TimelineSemaphore &operator=(TimelineSemaphore &&) noexcept = delete;
+  ~TimelineSemaphore() = default;
 };
 
 } // namespace engine::core
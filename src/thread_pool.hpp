@@ -0,0 +1,84 @@
+#pragma once
+
+#include <condition_variable> // for condition_variable
+#include <cstddef>            // for size_t
+#include <functional>         // for function
+#include <future>             // for future, packaged_task
+#include <memory>             // for make_shared
+#include <mutex>              // for mutex, unique_lock
+#include <queue>              // for queue
+#include <thread>             // for jthread, hardware_concurrency
+#include <type_traits>        // for invoke_result_t
+#include <utility>            // for move, forward
+#include <vector>             // for vector
+
+namespace engine::core {
+
+// Fixed set of worker threads executing submitted tasks in FIFO order.
+class ThreadPool {
+private:
+  std::vector<std::jthread> m_workers;
+  std::queue<std::function<void()>> m_tasks;
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  bool m_stop = false;
+
+  void work() {
+    while (true) {
+      std::function<void()> task;
+      {
+        std::unique_lock lock(m_mutex);
+        m_cv.wait(lock, [this] { return m_stop || !m_tasks.empty(); });
+        if (m_stop && m_tasks.empty()) {
+          return;
+        }
+        task = std::move(m_tasks.front());
+        m_tasks.pop();
+      }
+      task();
+    }
+  }
+
+public:
+  ThreadPool(std::size_t threads = std::thread::hardware_concurrency()) {
+    threads = threads == 0 ? 1 : threads;
+    m_workers.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i) {
+      m_workers.emplace_back([this] { work(); });
+    }
+  }
+
+  template <typename F>
+  auto submit(F &&function) -> std::future<std::invoke_result_t<F>> {
+    // std::function requires copyable callables, hence the shared_ptr
+    auto task = std::make_shared<std::packaged_task<std::invoke_result_t<F>()>>(
+        std::forward<F>(function));
+    auto future = task->get_future();
+    {
+      const std::lock_guard lock(m_mutex);
+      m_tasks.emplace([task] { (*task)(); });
+    }
+    m_cv.notify_one();
+    return future;
+  }
+
+  [[nodiscard]] std::size_t size() const { return m_workers.size(); }
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool(ThreadPool &&) noexcept = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+  ThreadPool &operator=(ThreadPool &&) noexcept = delete;
+
+  // finishes queued tasks before joining the workers
+  ~ThreadPool() {
+    {
+      const std::lock_guard lock(m_mutex);
+      m_stop = true;
+    }
+    m_cv.notify_all();
+    // join here, workers must not outlive the queue and its mutex
+    m_workers.clear();
+  }
+};
+
+} // namespace engine::core
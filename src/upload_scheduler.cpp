@@ -0,0 +1,219 @@
+#include "upload_scheduler.hpp"
+#include "queue.hpp"          // for CommandQueue
+#include "renderer.hpp"       // for Renderer
+#include "staging_ring.hpp"   // for StagingRing
+#include "vulkan_buffers.hpp" // for Buffer
+#include <algorithm>          // for any_of, min
+#include <cstring>            // for memcpy
+#include <utility>            // for swap
+
+namespace engine::core {
+
+namespace {
+
+// how a buffer with `usage` is read by the graphics queue after an upload
+VkAccessFlags consumer_access(VkBufferUsageFlags usage) {
+  VkAccessFlags access = 0;
+  if (usage & VK_BUFFER_USAGE_VERTEX_BUFFER_BIT) {
+    access |= VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+  }
+  if (usage & VK_BUFFER_USAGE_INDEX_BUFFER_BIT) {
+    access |= VK_ACCESS_INDEX_READ_BIT;
+  }
+  if (usage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT) {
+    access |= VK_ACCESS_UNIFORM_READ_BIT;
+  }
+  if (usage & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT) {
+    access |= VK_ACCESS_SHADER_READ_BIT;
+  }
+  if (usage & VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT) {
+    access |= VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+  }
+  return access;
+}
+
+VkPipelineStageFlags consumer_stages(VkBufferUsageFlags usage) {
+  VkPipelineStageFlags stages = 0;
+  if (usage & (VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+               VK_BUFFER_USAGE_INDEX_BUFFER_BIT)) {
+    stages |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+  }
+  if (usage & (VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT |
+               VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)) {
+    stages |= VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+              VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+              VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+  }
+  if (usage & VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT) {
+    stages |= VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
+  }
+  return stages == 0 ? VK_PIPELINE_STAGE_ALL_COMMANDS_BIT : stages;
+}
+
+} // namespace
+
+bool UploadHandle::complete() const {
+  return m_scheduler == nullptr || m_scheduler->is_complete(m_batch);
+}
+
+UploadScheduler::UploadScheduler(Renderer &renderer)
+    : m_renderer(renderer),
+      m_transfer_family(renderer.queue(CommandQueue::Kind::TRANSFER).index()),
+      m_graphics_family(renderer.queue(CommandQueue::Kind::GRAPHICS).index()) {}
+
+UploadHandle UploadScheduler::enqueue(const Buffer &dst,
+                                      std::span<const std::byte> data,
+                                      VkDeviceSize dst_offset) {
+  // nothing would ever flush the batch, the handle is complete right away
+  if (data.empty()) {
+    return {};
+  }
+  StagingRing &ring = m_renderer.staging_ring();
+  const VkDeviceSize max_chunk = ring.capacity() / 2;
+
+  for (VkDeviceSize done = 0; done < data.size();) {
+    const VkDeviceSize chunk =
+        std::min<VkDeviceSize>(data.size() - done, max_chunk);
+
+    auto region = ring.try_allocate(chunk);
+    if (!region) {
+      // ring is full of not yet submitted data: kick it off and wait for
+      // the oldest batch if that is still not enough
+      flush();
+      region = ring.allocate(chunk);
+    }
+    std::memcpy(region->data, data.data() + done,
+                static_cast<std::size_t>(chunk));
+    m_pending.push_back(
+        {.src = region->buffer,
+         .dst = dst.buffer(),
+         .region = {.srcOffset = region->offset,
+                    .dstOffset = dst_offset + done,
+                    .size = chunk},
+         .transfer_ownership =
+             m_transfer_family != m_graphics_family &&
+             dst.sharing_mode() == VK_SHARING_MODE_EXCLUSIVE,
+         .consumer_access = consumer_access(dst.usage()),
+         .consumer_stages = consumer_stages(dst.usage())});
+    done += chunk;
+  }
+
+  return {*this, ring.submitted_count() + 1};
+}
+
+void UploadScheduler::flush() {
+  release_finished();
+  if (m_pending.empty()) {
+    return;
+  }
+
+  // release barriers are recorded once per buffer, after all of its copies
+  std::vector<VkBufferMemoryBarrier> releases;
+  VkPipelineStageFlags wait_stages = 0;
+  for (const auto &copy : m_pending) {
+    wait_stages |= copy.consumer_stages;
+    if (!copy.transfer_ownership ||
+        std::any_of(releases.begin(), releases.end(),
+                    [&copy](const auto &b) { return b.buffer == copy.dst; })) {
+      continue;
+    }
+    VkBufferMemoryBarrier barrier{
+        .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+        .pNext = nullptr,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = 0,
+        .srcQueueFamilyIndex = m_transfer_family,
+        .dstQueueFamilyIndex = m_graphics_family,
+        .buffer = copy.dst,
+        .offset = 0,
+        .size = VK_WHOLE_SIZE};
+    releases.push_back(barrier);
+
+    // matching acquire, recorded by the graphics queue
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = copy.consumer_access;
+    m_flushed.acquires.push_back(barrier);
+    m_flushed.acquire_stages |= copy.consumer_stages;
+  }
+
+  CommandBuffer command_buffer =
+      m_renderer.transfer_command_pool().acquire_one_shot();
+  command_buffer.record(
+      [this, &releases](VkCommandBuffer command_buffer) {
+        for (const auto &copy : m_pending) {
+          vkCmdCopyBuffer(command_buffer, copy.src, copy.dst, 1,
+                          &copy.region);
+        }
+        if (!releases.empty()) {
+          vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                               VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0,
+                               nullptr,
+                               static_cast<unsigned>(releases.size()),
+                               releases.data(), 0, nullptr);
+        }
+      },
+      VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+  m_pending.clear();
+
+  StagingRing &ring = m_renderer.staging_ring();
+  const std::uint64_t value = ring.close_submission();
+  const VkTimelineSemaphoreSubmitInfo timeline_info{
+      .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+      .pNext = nullptr,
+      .waitSemaphoreValueCount = 0,
+      .pWaitSemaphoreValues = nullptr,
+      .signalSemaphoreValueCount = 1,
+      .pSignalSemaphoreValues = &value};
+
+  const VkCommandBuffer buffer = command_buffer.buffer();
+  const VkSemaphore signal = ring.timeline();
+  const VkSubmitInfo submit_info{.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+                                 .pNext = &timeline_info,
+                                 .waitSemaphoreCount = 0,
+                                 .pWaitSemaphores = nullptr,
+                                 .pWaitDstStageMask = nullptr,
+                                 .commandBufferCount = 1,
+                                 .pCommandBuffers = &buffer,
+                                 .signalSemaphoreCount = 1,
+                                 .pSignalSemaphores = &signal};
+
+  m_renderer.queue(CommandQueue::Kind::TRANSFER)
+      .submit(submit_info, VK_NULL_HANDLE);
+
+  m_in_flight.push_back({.id = value, .command_buffer = command_buffer});
+  // waiting for the latest value covers every earlier batch as well
+  m_flushed.timeline = signal;
+  m_flushed.value = value;
+  m_flushed.wait_stages |= wait_stages;
+}
+
+const UploadScheduler::FrameDependencies &
+UploadScheduler::take_frame_dependencies() {
+  std::swap(m_taken, m_flushed);
+  m_flushed.timeline = VK_NULL_HANDLE;
+  m_flushed.value = 0;
+  m_flushed.wait_stages = 0;
+  m_flushed.acquires.clear();
+  m_flushed.acquire_stages = 0;
+
+  // the acquire barriers chain to the semaphore wait through their stages
+  m_taken.wait_stages |= m_taken.acquire_stages;
+  return m_taken;
+}
+
+bool UploadScheduler::is_complete(std::uint64_t batch) const {
+  return m_renderer.staging_ring().finished(batch);
+}
+
+void UploadScheduler::release_finished() {
+  StagingRing &ring = m_renderer.staging_ring();
+  ring.reclaim();
+  CommandPool &pool = m_renderer.transfer_command_pool();
+  while (!m_in_flight.empty() &&
+         m_in_flight.front().id <= ring.completed_count()) {
+    pool.recycle(m_in_flight.front().command_buffer);
+    m_in_flight.pop_front();
+  }
+}
+
+} // namespace engine::core
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "command_buffers.hpp"  // for CommandBuffer
+#include <cstddef>              // for byte, size_t
+#include <cstdint>              // for uint64_t
+#include <deque>                // for deque
+#include <span>                 // for span
+#include <vector>               // for vector
+#include <vulkan/vulkan_core.h> // for VkBuffer, VkDeviceSize, VkSemaphore
+
+namespace engine::core {
+
+class Renderer;
+class Buffer;
+class UploadScheduler;
+
+// Lightweight handle to an enqueued upload. Data is visible to every graphics
+// submit recorded after `Renderer::render_frame` flushed the batch, so
+// `complete` is only needed when the CPU has to know that the copy landed.
+class UploadHandle {
+private:
+  const UploadScheduler *m_scheduler = nullptr;
+  std::uint64_t m_batch = 0;
+
+public:
+  UploadHandle() = default;
+  UploadHandle(const UploadScheduler &scheduler, std::uint64_t batch)
+      : m_scheduler(&scheduler), m_batch(batch) {}
+
+  [[nodiscard]] std::uint64_t batch() const { return m_batch; }
+  [[nodiscard]] bool complete() const;
+};
+
+// Collects buffer uploads and records them into a single transfer submit per
+// flush. Every flush signals the next value of the staging ring's timeline
+// semaphore and the next graphics submit waits for the latest one, so uploads
+// never block the calling thread on a queue drain.
+//
+// With a dedicated transfer family, exclusive destination buffers are released
+// at the end of the transfer batch and have to be acquired by the graphics
+// queue before use: `FrameDependencies::acquires` must be recorded outside of
+// a render pass at the start of the frame's command buffer.
+class UploadScheduler {
+public:
+  // `timeline` is null when nothing was flushed since the last frame
+  struct FrameDependencies {
+    VkSemaphore timeline = VK_NULL_HANDLE;
+    std::uint64_t value = 0;
+    VkPipelineStageFlags wait_stages = 0;
+    std::vector<VkBufferMemoryBarrier> acquires;
+    VkPipelineStageFlags acquire_stages = 0;
+  };
+
+  UploadScheduler(Renderer &renderer);
+
+  // copies `data` into the staging ring right away, the GPU copy is deferred
+  // until the next `flush`; empty uploads return a complete handle
+  UploadHandle enqueue(const Buffer &dst, std::span<const std::byte> data,
+                       VkDeviceSize dst_offset = 0);
+
+  // submits every pending copy in one batch, no-op if nothing is pending
+  void flush();
+
+  // hands the timeline wait and acquire barriers of batches flushed since
+  // the previous call to the next graphics submit
+  [[nodiscard]] const FrameDependencies &take_frame_dependencies();
+
+  [[nodiscard]] bool is_complete(std::uint64_t batch) const;
+
+  UploadScheduler(const UploadScheduler &) = delete;
+  UploadScheduler(UploadScheduler &&) noexcept = delete;
+  UploadScheduler &operator=(const UploadScheduler &) = delete;
+  UploadScheduler &operator=(UploadScheduler &&) noexcept = delete;
+  ~UploadScheduler() = default;
+
+private:
+  struct Copy {
+    VkBuffer src = VK_NULL_HANDLE;
+    VkBuffer dst = VK_NULL_HANDLE;
+    VkBufferCopy region{};
+    bool transfer_ownership = false;
+    VkAccessFlags consumer_access = 0;
+    VkPipelineStageFlags consumer_stages = 0;
+  };
+
+  struct Batch {
+    std::uint64_t id = 0;
+    CommandBuffer command_buffer;
+  };
+
+  Renderer &m_renderer;
+  unsigned m_transfer_family = 0;
+  unsigned m_graphics_family = 0;
+  std::vector<Copy> m_pending;
+  std::deque<Batch> m_in_flight;
+
+  // flushed, not yet handed to a frame
+  FrameDependencies m_flushed;
+  FrameDependencies m_taken;
+
+  void release_finished();
+};
+
+} // namespace engine::core
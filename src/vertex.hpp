@@ -1,8 +1,10 @@
 #pragma once
 
+#include "glm/mat4x4.hpp"
 #include "glm/vec2.hpp"
 #include "glm/vec3.hpp"
 #include "glm/vec4.hpp"
+#include <array>
 #include <cstddef>
 #include <vulkan/vulkan_core.h>
 
@@ -50,4 +52,11 @@ struct Vertex {
   }
 };
 
+// Per-instance data of instanced draws. Instanced vertex shaders read it as
+// `mat4 transforms[]` from binding 0 of the renderer's instance set, see
+// `Renderer::instance_set_layout`.
+struct InstanceData {
+  glm::mat4 transform{1.0f}; // NOLINT
+};
+
 } // namespace engine::resources
@@ -1,12 +1,13 @@
 #include "vulkan_buffers.hpp"
 #include "command_buffers.hpp"         // for CommandBuffer, CommandPool
-#include "engine_exceptions.hpp"       // for BufferCreationError, MemoryAl...
-#include "physical_device_queries.hpp" // for find_memory_type
+#include "cpu_profiler.hpp"            // for CpuScope
+#include "engine_exceptions.hpp"       // for BufferCreationError
 #include "queue.hpp"                   // for CommandQueue
 #include "renderer.hpp"                // for Renderer
+#include "upload_scheduler.hpp"        // for UploadScheduler, UploadHandle
+#include <cassert>                     // for assert
 #include <cstddef>                     // for byte
 #include <cstring>                     // for memcpy, size_t
-#include <vector>                      // for vector
 #include <vulkan/vulkan_core.h>        // for VkStructureType, VK_NULL_HANDLE
 
 namespace engine::core {
@@ -14,7 +15,8 @@ namespace engine::core {
 Buffer::Buffer(Renderer &renderer, VkDeviceSize size, VkBufferUsageFlags usage,
                VkSharingMode sharing_mode, unsigned queue_family_index_count,
                const unsigned *queue_family_indices)
-    : m_size(size), m_renderer(&renderer) {
+    : m_size(size), m_usage(usage), m_sharing_mode(sharing_mode),
+      m_renderer(&renderer) {
   const VkBufferCreateInfo create_info{
       .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
       .pNext = nullptr,
@@ -34,36 +36,28 @@ Buffer::Buffer(Renderer &renderer, VkDeviceSize size, VkBufferUsageFlags usage,
 }
 
 Buffer &Buffer::allocate(unsigned mem_properties) {
+  const CpuScope scope("allocate buffer");
   VkMemoryRequirements mem_requirements;
   vkGetBufferMemoryRequirements(m_renderer->device(), m_buffer,
                                 &mem_requirements);
 
-  const VkMemoryAllocateInfo allocInfo{
-      .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-      .pNext = nullptr,
-      .allocationSize = mem_requirements.size,
-      .memoryTypeIndex =
-          find_memory_type(m_renderer->physical_device(),
-                           mem_requirements.memoryTypeBits, mem_properties),
-  };
-
-  VkDeviceMemory memory = VK_NULL_HANDLE;
-  if (vkAllocateMemory(m_renderer->device(), &allocInfo, nullptr, &memory) !=
-      VK_SUCCESS) {
-    throw exceptions::MemoryAllocationError{};
-  }
-  m_memory = {memory, m_renderer->device()};
+  m_allocation =
+      m_renderer->allocator().allocate(mem_requirements, mem_properties);
 
-  vkBindBufferMemory(m_renderer->device(), m_buffer, m_memory, 0);
+  vkBindBufferMemory(m_renderer->device(), m_buffer, m_allocation.memory(),
+                     m_allocation.offset());
 
   return *this;
 }
 
 void Buffer::upload(const std::byte *data) {
-  void *mapped = nullptr;
-  vkMapMemory(m_renderer->device(), m_memory, 0, m_size, 0, &mapped);
-  std::memcpy(mapped, data, static_cast<std::size_t>(m_size));
-  vkUnmapMemory(m_renderer->device(), m_memory);
+  assert(m_allocation.mapped() && "buffer memory is not host visible");
+  std::memcpy(m_allocation.mapped(), data, static_cast<std::size_t>(m_size));
+}
+
+UploadHandle Buffer::upload_staged(std::span<const std::byte> data,
+                                   VkDeviceSize offset) {
+  return m_renderer->uploads().enqueue(*this, data, offset);
 }
 
 Buffer::Buffer(const Buffer &other) { *this = other; }
@@ -72,8 +66,8 @@ Buffer &Buffer::operator=(const Buffer &other) {
   if (this == &other) {
     return *this;
   }
-  CommandBuffer command_buffer =
-      m_renderer->transfer_command_pool().make_command_buffers(1).front();
+  CommandPool &pool = m_renderer->transfer_command_pool();
+  const CommandBuffer command_buffer = pool.acquire_one_shot();
 
   command_buffer.record(
       [this, &other](VkCommandBuffer command_buffer) {
@@ -96,7 +90,7 @@ Buffer &Buffer::operator=(const Buffer &other) {
       .submit(submit_info, VK_NULL_HANDLE)
       .wait_idle();
 
-  m_renderer->transfer_command_pool().free_command_buffers({command_buffer});
+  pool.recycle(command_buffer);
 
   return *this;
 }
@@ -1,24 +1,34 @@
 #pragma once
 
+#include "memory_allocator.hpp"   // for MemoryAllocation
 #include "vulkan_destroyable.hpp" // for VkDestroyable, VkBufferWrapper
 #include <cstddef>                // for byte
+#include <span>                   // for span
 #include <vulkan/vulkan_core.h>   // for VkSharingMode, VkDeviceSize, VkBuffer
 
 namespace engine::core {
 
 class Renderer;
+class UploadHandle;
 
 class Buffer {
 private:
+  // declared before the buffer, so the buffer is destroyed first
+  MemoryAllocation m_allocation;
   VkDestroyable<VkBufferWrapper> m_buffer;
   VkDeviceSize m_size = 0;
-  VkDestroyable<VkDeviceMemoryWrapper> m_memory;
+  VkBufferUsageFlags m_usage = 0;
+  VkSharingMode m_sharing_mode = VK_SHARING_MODE_EXCLUSIVE;
   Renderer *m_renderer = nullptr;
 
 public:
   Buffer() = default;
 
   [[nodiscard]] VkBuffer buffer() const { return m_buffer; }
+  [[nodiscard]] VkDeviceSize size() const { return m_size; }
+  [[nodiscard]] std::byte *mapped() const { return m_allocation.mapped(); }
+  [[nodiscard]] VkBufferUsageFlags usage() const { return m_usage; }
+  [[nodiscard]] VkSharingMode sharing_mode() const { return m_sharing_mode; }
 
   Buffer(Renderer &renderer, VkDeviceSize size, VkBufferUsageFlags usage,
          VkSharingMode sharing_mode = VK_SHARING_MODE_EXCLUSIVE,
@@ -29,6 +39,13 @@ public:
 
   void upload(const std::byte *data);
 
+  // schedules a copy of `data` to `offset` of a (device local) buffer
+  // through the renderer's staging ring, does not wait for the GPU.
+  // Exclusive buffers are released by the transfer queue and acquired by the
+  // graphics queue; concurrent ones are used by both queues as is
+  UploadHandle upload_staged(std::span<const std::byte> data,
+                             VkDeviceSize offset = 0);
+
   Buffer(const Buffer &other);
   Buffer &operator=(const Buffer &other);
 
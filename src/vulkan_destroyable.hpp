@@ -100,12 +100,19 @@ ENGINE_CORE_VK_DESTROYABLE_OBJECT_WRAPPER_SPEC(VkRenderPass,
 ENGINE_CORE_VK_DESTROYABLE_OBJECT_WRAPPER_SPEC(VkFramebuffer,
                                                vkDestroyFramebuffer);
 ENGINE_CORE_VK_DESTROYABLE_OBJECT_WRAPPER_SPEC(VkPipeline, vkDestroyPipeline);
+ENGINE_CORE_VK_DESTROYABLE_OBJECT_WRAPPER_SPEC(VkPipelineCache,
+                                               vkDestroyPipelineCache);
 ENGINE_CORE_VK_DESTROYABLE_OBJECT_WRAPPER_SPEC(VkCommandPool,
                                                vkDestroyCommandPool);
 ENGINE_CORE_VK_DESTROYABLE_OBJECT_WRAPPER_SPEC(VkFence, vkDestroyFence);
 ENGINE_CORE_VK_DESTROYABLE_OBJECT_WRAPPER_SPEC(VkSemaphore, vkDestroySemaphore);
 ENGINE_CORE_VK_DESTROYABLE_OBJECT_WRAPPER_SPEC(VkBuffer, vkDestroyBuffer);
 ENGINE_CORE_VK_DESTROYABLE_OBJECT_WRAPPER_SPEC(VkDeviceMemory, vkFreeMemory);
+ENGINE_CORE_VK_DESTROYABLE_OBJECT_WRAPPER_SPEC(VkQueryPool, vkDestroyQueryPool);
+ENGINE_CORE_VK_DESTROYABLE_OBJECT_WRAPPER_SPEC(VkDescriptorSetLayout,
+                                               vkDestroyDescriptorSetLayout);
+ENGINE_CORE_VK_DESTROYABLE_OBJECT_WRAPPER_SPEC(VkDescriptorPool,
+                                               vkDestroyDescriptorPool);
 
 #undef ENGINE_CORE_VK_DESTROYABLE_OBJECT_WRAPPER_SPEC
 // NOLINTEND